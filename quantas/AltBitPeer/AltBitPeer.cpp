@@ -12,29 +12,27 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int AltBitPeer::currentTransaction = 1;
-
 	AltBitPeer::~AltBitPeer() {
 
 	}
 
-	AltBitPeer::AltBitPeer(const AltBitPeer& rhs) : Peer<AltBitMessage>(rhs) {
+	AltBitPeer::AltBitPeer(const AltBitPeer& rhs) : Peer<AltBitMessage>(rhs), shared(rhs.shared) {
 
 	}
 
-	AltBitPeer::AltBitPeer(long id) : Peer(id) {
+	AltBitPeer::AltBitPeer(long id) : Peer(id), shared(sharedState<AltBitShared>()) {
 
 	}
 
 	void AltBitPeer::performComputation() {
 		if (alive) {
 			if (getRound() == 0 && id() == 0) {
-				submitTrans(currentTransaction);
+				submitTrans(shared.currentTransaction);
 			}
 			if (previousMessageRound + timeOutRate < getRound()) {// resend lost message
 				if (id() == 0) {
 					AltBitMessage message;
-					message.action = "data";
+					message.action = AltBitAction::data;
 					message.roundSubmitted = getRound(); // if message lost roundSubmitted isn't accurate
 					message.messageNum = ns;
 					previousMessageRound = getRound();
@@ -42,7 +40,7 @@ namespace quantas {
 				}
 				else {
 					AltBitMessage message;
-					message.action = "ack";
+					message.action = AltBitAction::ack;
 					message.roundSubmitted = getRound(); // if message lost roundSubmitted isn't accurate
 					message.messageNum = ns;
 					previousMessageRound = getRound();
@@ -52,23 +50,23 @@ namespace quantas {
 			while (!inStreamEmpty()) {
 				Packet<AltBitMessage> packet = popInStream();
 				long source = packet.sourceId();
-				AltBitMessage message = packet.getMessage();
+				AltBitMessage message = packet.takeMessage();
 				if (randMod(messageLossDen) < messageLossNum) { // used for message loss
 					continue;
 				}
-				if (message.action == "ack") {
+				if (message.action == AltBitAction::ack) {
 					if (message.messageNum == ns) {
 						previousMessageRound = getRound();
 						requestsSatisfied++;
 						ns++;
-						submitTrans(currentTransaction);
+						submitTrans(shared.currentTransaction);
 					}
 
 				}
-				else if (message.action == "data") {
+				else if (message.action == AltBitAction::data) {
 					previousMessageRound = getRound();
 					ns = message.messageNum;
-					message.action = "ack";
+					message.action = AltBitAction::ack;
 					sendMessage(0, message);
 
 				}
@@ -89,18 +87,18 @@ namespace quantas {
 
 	void AltBitPeer::sendMessage(long peer, AltBitMessage message) {
 		Packet<AltBitMessage> newMessage(getRound(), peer, id());
-		newMessage.setMessage(message);
-		pushToOutSteam(newMessage);
+		newMessage.setMessage(std::move(message));
+		pushToOutStream(std::move(newMessage));
 		messagesSent++;
 	}
 
 	void AltBitPeer::submitTrans(int tranID) {
 		AltBitMessage message;
-		message.action = "data";
+		message.action = AltBitAction::data;
 		message.roundSubmitted = getRound();
 		message.messageNum = ns;
 		sendMessage(1, message);
-		currentTransaction++;
+		shared.currentTransaction++;
 	}
 
 	std::ostream& AltBitPeer::printTo(std::ostream& out)const {
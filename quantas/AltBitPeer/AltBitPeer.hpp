@@ -16,12 +16,21 @@ You should have received a copy of the GNU General Public License along with QUA
 namespace quantas {
 
 
+	// what an alternating bit message carries
+	enum class AltBitAction { none, data, ack };
+
 	struct AltBitMessage {
-		string action; // options are ack, data
+		AltBitAction action = AltBitAction::none;
 		int messageNum;
 		int roundSubmitted;
 	};
 
+	// values shared by the peers of one simulation, they live in its SimulationContext
+	struct AltBitShared {
+		// the id of the next transaction to submit
+		int  currentTransaction = 1;
+	};
+
 	class AltBitPeer : public Peer<AltBitMessage> {
 	public:
 		// methods that must be defined when deriving from Peer
@@ -38,8 +47,8 @@ namespace quantas {
 		void                 log()const { printTo(*_log); };
 		ostream& printTo(ostream&)const;
 
-		// the id of the next transaction to submit
-		static int                      currentTransaction;
+		// values shared with the other peers of the simulation
+		AltBitShared&                   shared;
 		// number of requests satisfied
 		int requestsSatisfied = 0;
 		// number of messages sent
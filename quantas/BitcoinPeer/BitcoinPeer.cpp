@@ -12,18 +12,15 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int BitcoinPeer::currentTransaction = 1;
-	mutex BitcoinPeer::currentTransaction_mutex;
-
 	BitcoinPeer::~BitcoinPeer() {
 
 	}
 
-	BitcoinPeer::BitcoinPeer(const BitcoinPeer& rhs) : Peer<BitcoinMessage>(rhs) {
+	BitcoinPeer::BitcoinPeer(const BitcoinPeer& rhs) : Peer<BitcoinMessage>(rhs), shared(rhs.shared) {
 		
 	}
 
-	BitcoinPeer::BitcoinPeer(long id) : Peer(id) {
+	BitcoinPeer::BitcoinPeer(long id) : Peer(id), shared(sharedState<BitcoinShared>()) {
 		
 	}
 
@@ -95,10 +92,10 @@ namespace quantas {
 	}
 
 	void BitcoinPeer::submitTrans() {
-		const lock_guard<mutex> lock(currentTransaction_mutex);
+		const lock_guard<mutex> lock(shared.currentTransaction_mutex);
 		BitcoinMessage message;
 		message.mined = false;
-		message.block.trans.id = currentTransaction++;
+		message.block.trans.id = shared.currentTransaction++;
 		message.block.trans.roundSubmitted = getRound();
 		broadcast(message);
 	}
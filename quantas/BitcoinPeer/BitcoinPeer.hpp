@@ -41,6 +41,13 @@ namespace quantas {
         bool				mined = false; // decides if it's a mined block or submitted transaction
     };
 
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct BitcoinShared {
+        // the id of the next transaction to submit
+        int    currentTransaction = 1;
+        mutex  currentTransaction_mutex;
+    };
+
     class BitcoinPeer : public Peer<BitcoinMessage> {
     public:
         // methods that must be defined when deriving from Peer
@@ -70,9 +77,8 @@ namespace quantas {
         int                   submitRate = 20;
         // rate at which to mine blocks ie 1 in x chance for all n nodes
         int                   mineRate = 40;
-        // the id of the next transaction to submit
-        static int            currentTransaction;
-        static mutex          currentTransaction_mutex;
+        // values shared with the other peers of the simulation
+        BitcoinShared&        shared;
 
         // checkInStrm loops through the in stream adding blocks to unlinked or transactions
         void                  checkInStrm();
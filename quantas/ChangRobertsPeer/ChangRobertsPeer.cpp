@@ -49,6 +49,10 @@ namespace quantas {
 				}
 			}	
 		}
+		// nothing to do until the next message, unless the election has to be reported
+		if (!first_elected) {
+			idleUntil();
+		}
 	}
 
 	void ChangRobertsPeer::endOfRound(const vector<Peer<ChangRobertsMessage>*>& _peers) {
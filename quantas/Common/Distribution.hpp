@@ -8,13 +8,26 @@ You should have received a copy of the GNU General Public License along with QUA
 */
 
 // This class handles the distribution of channel delays in the network. The distribution can be uniform, Poisson or one. 
+//
+// setDistribution compiles the distribution into an alias table over the delays [minDelay, maxDelay] (a Poisson
+// distribution is cut off at both ends, as rejecting the samples outside the range did), so a delay is drawn with
+// one random number and one table lookup whatever the type.
+//
+// Random numbers come from RANDOM_GENERATOR, a counter based generator of which every thread has one. The simulation
+// points it at the stream of the peer being computed (see SimulationContext::useStream), the n-th number of a stream
+// being a hash of its key and n, so a peer draws the same numbers whichever thread computes it. Threads outside a
+// simulation draw from a stream seeded from the time and their id.
 
 
 #ifndef Distribution_hpp
 #define Distribution_hpp
 
 #include <string>
+#include <cstdint>
+#include <ctime>
 #include <random>
+#include <vector>
+#include <cmath>
 #include <iostream>
 #include <thread>
 #include "Json.hpp"
@@ -24,14 +37,58 @@ namespace quantas{
 
     using std::string;
     using std::uniform_int_distribution;
-    using std::poisson_distribution;
-    using std::default_random_engine;
+    using std::vector;
     using nlohmann::json;
     using std::cerr;
 
-    // random number generator that will be created and seeded uniquely once in
-    // each thread
-    extern thread_local default_random_engine RANDOM_GENERATOR;
+    // Counter based random number generator (SplitMix64). A stream is keyed by the seed of the simulation, the test,
+    // the round, the phase of the round and the peer it is drawn for, and holds no other state than the count of
+    // numbers drawn. Satisfies UniformRandomBitGenerator so it can be used with the standard distributions.
+    class RandomStream {
+    private:
+        uint64_t                            _key = 0;
+        uint64_t                            _counter = 0;
+
+        static uint64_t                     mix                 (uint64_t z) {
+            z += 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+    public:
+        typedef uint64_t                    result_type;
+
+        RandomStream                                            (uint64_t seed) : _key(mix(seed)) {};
+
+        // starts the stream of the given key over
+        void                                reset               (uint64_t seed, int test, int round, int phase, long stream) {
+            _key = mix(mix(mix(mix(mix(seed) + (uint64_t)test) + (uint64_t)round) + (uint64_t)phase) + (uint64_t)stream);
+            _counter = 0;
+        }
+
+        static constexpr result_type        min                 () {return 0;};
+        static constexpr result_type        max                 () {return UINT64_MAX;};
+        result_type                         operator()          () {return mix(_key + 0x9e3779b97f4a7c15ULL * _counter++);};
+        // a number in [0, range) without modulo bias, see Lemire, "Fast Random Integer Generation in an Interval"
+        uint64_t                            bounded             (uint64_t range);
+    };
+
+    inline uint64_t RandomStream::bounded(uint64_t range) {
+        unsigned __int128 product = (unsigned __int128)(*this)() * range;
+        uint64_t low = (uint64_t)product;
+        if (low < range) {
+            uint64_t threshold = (0 - range) % range;
+            while (low < threshold) {
+                product = (unsigned __int128)(*this)() * range;
+                low = (uint64_t)product;
+            }
+        }
+        return (uint64_t)(product >> 64);
+    }
+
+    // random number generator of the calling thread, see RandomStream
+    extern thread_local RandomStream RANDOM_GENERATOR;
 
     // convenience function for using the random number generator to get a
     // random int in the range [min, max]
@@ -47,21 +104,33 @@ namespace quantas{
     static const string                ONE     = "ONE";
     class Distribution {
     private:
+        enum Type { TYPE_UNIFORM, TYPE_POISSON, TYPE_ONE };
+
         int                                 _avgDelay = 1;
         int                                 _maxDelay = 1;
         int                                 _minDelay = 1;
-        string                              _type = ONE;
+        Type                                _type = TYPE_ONE;
+
+        // alias table, slot i stands for delay _firstDelay + i
+        int                                 _firstDelay = 1;
+        vector<uint64_t>                    _keep;      // chance out of 2^32 that a slot gives its own delay
+        vector<uint32_t>                    _alias;     // slot whose delay is given otherwise
+
+        // builds the alias table for the current type and delays
+        void                                compile             ();
 
     public:
         Distribution                                                 () {
             _avgDelay = 1;
             _maxDelay = 1;
             _minDelay = 1;
-            _type = UNIFORM;
+            _type = TYPE_UNIFORM;
+            compile();
         }
 
-        Distribution                                                 (const Distribution&);
-        ~Distribution                                                ();
+        Distribution                                                 (const Distribution&) = default;
+        Distribution&                       operator=           (const Distribution&) = default;
+        ~Distribution                                                () = default;
 
         // setters
         
@@ -71,26 +140,13 @@ namespace quantas{
         int                                 maxDelay            ()const                                         {return _maxDelay;};
         int                                 avgDelay            ()const                                         {return _avgDelay;};
         int                                 minDelay            ()const                                         {return _minDelay;};
-        string                              type                ()const                                         {return _type;};
-        int                                 getDelay();
+        string                              type                ()const;
+        int                                 getDelay            ()const;
+        // draws count delays at once
+        void                                getDelays           (int *delays, int count)const;
 
     };
 
-    inline Distribution::Distribution(const Distribution &rhs){
-        if(this == &rhs){
-            return;
-        }
-
-        _avgDelay = rhs._avgDelay;
-        _maxDelay = rhs._maxDelay;
-        _minDelay = rhs._minDelay;
-        _type = rhs._type;
-    }
-
-    inline Distribution::~Distribution(){
-        
-    }
-
     inline void Distribution::setDistribution(json distribution) {
         if (distribution.contains("avgDelay")) {
             _avgDelay = distribution["avgDelay"];
@@ -105,34 +161,98 @@ namespace quantas{
         if (distribution.contains("type")) {
             string type = distribution["type"];
             if (type == UNIFORM) {
-                _type = UNIFORM;
+                _type = TYPE_UNIFORM;
             }
             else if (type == POISSON) {
-                _type = POISSON;
+                _type = TYPE_POISSON;
             }
             else if (type == ONE) {
-                _type = ONE;
+                _type = TYPE_ONE;
             }
         }
+        compile();
     }
-    
-    inline int Distribution::getDelay(){
-        int delay = -1;
-        do {
-            if (_type == UNIFORM) {
-                delay = uniformInt(_minDelay, _maxDelay);
+
+    inline string Distribution::type()const {
+        switch (_type) {
+            case TYPE_POISSON:
+                return POISSON;
+            case TYPE_ONE:
+                return ONE;
+            default:
+                return UNIFORM;
+        }
+    }
+
+    inline void Distribution::compile() {
+        // delays are at least one and within [minDelay, maxDelay]
+        _firstDelay = std::max(1, _minDelay);
+        int lastDelay = std::max(_firstDelay, _maxDelay);
+        if (_type == TYPE_ONE) {
+            _firstDelay = lastDelay = 1;
+        }
+        int slots = lastDelay - _firstDelay + 1;
+
+        // weight of each delay, the Poisson weights are scaled by the largest one (in log space) so
+        // that a range far from the average does not underflow
+        vector<double> weight(slots, 1.0);
+        if (_type == TYPE_POISSON) {
+            double mean = std::max(_avgDelay, 1);
+            double largest = -INFINITY;
+            for (int i = 0; i < slots; i++) {
+                int k = _firstDelay + i;
+                weight[i] = k * std::log(mean) - mean - std::lgamma(k + 1.0);
+                largest = std::max(largest, weight[i]);
             }
-            if (_type == POISSON) {
-                poisson_distribution<int> poissonDistribution(_avgDelay);
-                delay = poissonDistribution(RANDOM_GENERATOR);
+            for (int i = 0; i < slots; i++) {
+                weight[i] = std::exp(weight[i] - largest);
             }
-            if (_type == ONE) {
-                delay = 1;
+        }
+        double total = 0;
+        for (int i = 0; i < slots; i++) {
+            total += weight[i];
+        }
+
+        // Vose's alias method, every slot is filled up to the average with the excess of one larger slot
+        _keep.assign(slots, 1ULL << 32);
+        _alias.resize(slots);
+        vector<double> scaled(slots);
+        vector<int> small, large;
+        for (int i = 0; i < slots; i++) {
+            _alias[i] = i;
+            scaled[i] = weight[i] * slots / total;
+            if (scaled[i] < 1.0) {
+                small.push_back(i);
+            }
+            else {
+                large.push_back(i);
+            }
+        }
+        while (!small.empty() && !large.empty()) {
+            int less = small.back();
+            small.pop_back();
+            int more = large.back();
+            _keep[less] = (uint64_t)(scaled[less] * (1ULL << 32));
+            _alias[less] = more;
+            scaled[more] -= 1.0 - scaled[less];
+            if (scaled[more] < 1.0) {
+                large.pop_back();
+                small.push_back(more);
             }
-            // guard agenst 0 and negative numbers
-        } while (delay < 1 || delay > _maxDelay || delay < _minDelay);
+        }
+        // slots left over are full up to rounding
+    }
+    
+    inline int Distribution::getDelay()const{
+        uint64_t random = RANDOM_GENERATOR();
+        uint64_t slot = ((random >> 32) * _keep.size()) >> 32;
+        return _firstDelay + (int)((random & 0xffffffffULL) < _keep[slot] ? slot : _alias[slot]);
+    }
 
-        return delay;
+    inline void Distribution::getDelays(int *delays, int count)const{
+        for (int i = 0; i < count; i++) {
+            delays[i] = getDelay();
+        }
     }
 }
 #endif /* Distribution_hpp */
@@ -0,0 +1,77 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// A link model describes how a channel treats the packets sent over it. Without one a channel delivers
+// every packet, in order, after a delay drawn between 1 and the delay of the channel. A link model can
+//  "delay"     - draw the delay of each packet from its own distribution (see Distribution)
+//  "jitter"    - add between 0 and the given number of rounds to each delay
+//  "drop"      - lose a packet with the given probability
+//  "duplicate" - deliver a packet twice with the given probability
+//  "reorder"   - let a packet overtake the packets sent before it with the given probability
+//  "bandwidth" - send at most the given number of packets per round, the others queue for the next rounds
+//  "bytesPerRound" - send at most the given number of bytes per round (see MessageSize), a larger packet
+//                takes as many rounds as it needs to be sent
+//
+// Link models are set in the "links" object of the topology. "default" applies to every channel and
+// each entry of "edges" to the channels between its "from" and "to" peers (both directions unless
+// "directed" is true), for example
+//  "links": {"default": {"drop": 0.01}, "edges": [{"from": 0, "to": 1, "bandwidth": 2, "delay": {"type": "POISSON", "avgDelay": 3, "maxDelay": 8}}]}
+// The network owns the models, channels point to theirs (see NetworkInterface::transmit).
+
+#ifndef LinkModel_hpp
+#define LinkModel_hpp
+
+#include "Distribution.hpp"
+
+namespace quantas{
+
+    struct LinkModel {
+        bool                                hasDelay = false;       // whether delay replaces the delay of the channel
+        Distribution                        delay;
+        int                                 jitter = 0;
+        double                              drop = 0;
+        double                              duplicate = 0;
+        double                              reorder = 0;
+        int                                 packetsPerRound = 0;    // 0 for no limit
+        long                                bytesPerRound = 0;      // 0 for no limit
+
+        void                                setLinkModel        (json link);
+        // largest delay a packet can be given, not counting the rounds it queues
+        int                                 maxDelay            (int channelDelay)const {return (hasDelay ? delay.maxDelay() : channelDelay) + jitter;};
+        // true with the given probability
+        static bool                         chance              (double probability) {return probability > 0 && (RANDOM_GENERATOR() >> 11) * 0x1.0p-53 < probability;};
+    };
+
+    inline void LinkModel::setLinkModel(json link) {
+        if (link.contains("delay")) {
+            hasDelay = true;
+            delay.setDistribution(link["delay"]);
+        }
+        if (link.contains("jitter")) {
+            jitter = link["jitter"];
+        }
+        if (link.contains("drop")) {
+            drop = link["drop"];
+        }
+        if (link.contains("duplicate")) {
+            duplicate = link["duplicate"];
+        }
+        if (link.contains("reorder")) {
+            reorder = link["reorder"];
+        }
+        if (link.contains("bandwidth")) {
+            packetsPerRound = link["bandwidth"];
+        }
+        if (link.contains("bytesPerRound")) {
+            bytesPerRound = link["bytesPerRound"];
+        }
+    }
+}
+
+#endif /* LinkModel_hpp */
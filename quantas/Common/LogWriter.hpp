@@ -21,18 +21,43 @@ namespace quantas {
     using std::cout;
     using std::endl;
 
+    // Holds the results of a simulation and the round and test they are logged for. Every simulation
+    // context (see SimulationContext) has its own writer, instance() returns the one of the context the
+    // calling thread is working for.
     class LogWriter {
     protected:
         ostream* _log = &cout;
         int         _round = 0;
         int         _test = 0;
 
-    public:
-        static LogWriter*  instance () {
-            static LogWriter s;
-            return &s;
+        static void merge (json &into, const json &from) {
+            if (from.is_null()) {
+                return;
+            }
+            if (into.is_null() || into.type() != from.type() || !(from.is_object() || from.is_array())) {
+                into = from;
+            }
+            else if (from.is_object()) {
+                for (auto it = from.begin(); it != from.end(); ++it) {
+                    merge(into[it.key()], it.value());
+                }
+            }
+            else {
+                for (size_t i = 0; i < from.size(); i++) {
+                    if (i < into.size()) {
+                        merge(into[i], from[i]);
+                    }
+                    else {
+                        into.push_back(from[i]);
+                    }
+                }
+            }
         }
 
+    public:
+        // defined in SimulationContext.hpp
+        static LogWriter*  instance ();
+
         void print () {
             *_log << data.dump(4);
             *_log << endl;
@@ -46,8 +71,11 @@ namespace quantas {
         int                 getTest         ()const         { return _test; }
         void                setRound        (int round)     { _round = round; }
         int                 getRound        ()const         { return _round; }
+        // adds the data of another writer, values it does not have (null) are left as they are
+        void                merge           (const LogWriter &other) { merge(data, other.data); }
 
     private:
+        friend class SimulationContext;
         // copying and creation prohibited by clients
         LogWriter(){}
         LogWriter(const LogWriter&){}
@@ -55,4 +83,6 @@ namespace quantas {
 
 }
 
+#include "SimulationContext.hpp"
+
 #endif // LogWriter_hpp
@@ -0,0 +1,93 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// messageSize gives the number of bytes a message takes when it is sent. A message type can define
+//      size_t size() const;
+// to give its own size, otherwise its size is sizeof. That is only approximate for a message holding
+// strings or containers, since sizeof does not count what they point to. Strings and the standard
+// containers count a length followed by the size of each element (std::array has no length), so a
+// message holding containers can add up the size of its members, e.g.
+//      size_t size() const {return messageSize(blockChain) + messageSize(branches);};
+//
+// The network uses the size to count the bytes sent (see Network) and to queue packets on links with
+// a limited bandwidth (see LinkModel).
+
+#ifndef MessageSize_hpp
+#define MessageSize_hpp
+
+#include <cstddef>
+#include <array>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <type_traits>
+
+namespace quantas{
+
+    template<class T> size_t messageSize(const T &value);
+    template<class C, class R, class A> size_t messageSize(const std::basic_string<C, R, A> &value);
+    template<class T, size_t N> size_t messageSize(const std::array<T, N> &value);
+    template<class T, class U> size_t messageSize(const std::pair<T, U> &value);
+
+    namespace detail{
+        // containers are the types that can be iterated over, whether or not they have a size member
+        template<class T, class = void>
+        struct isContainer : std::false_type {};
+        template<class T>
+        struct isContainer<T, decltype(void(std::begin(std::declval<const T&>())), void(std::end(std::declval<const T&>())))> : std::true_type {};
+
+        template<class T, class = void>
+        struct hasSizeMember : std::false_type {};
+        template<class T>
+        struct hasSizeMember<T, decltype(void(static_cast<size_t>(std::declval<const T&>().size())))> : std::true_type {};
+
+        // types other than containers with a size member give their own size
+        template<class T>
+        struct hasOwnSize : std::integral_constant<bool, hasSizeMember<T>::value && !isContainer<T>::value> {};
+
+        // elements one after the other, sized together when they are plain data
+        template<class Container>
+        size_t elementsSize(const Container &value) {
+            typedef typename std::decay<decltype(*std::begin(value))>::type Element;
+            if (std::is_trivially_copyable<Element>::value && !hasOwnSize<Element>::value && !isContainer<Element>::value) {
+                return std::distance(std::begin(value), std::end(value)) * sizeof(Element);
+            }
+            size_t total = 0;
+            for (const auto &element : value) {
+                total += messageSize(element);
+            }
+            return total;
+        }
+
+        template<class T>
+        size_t ownSize(const T &value, std::true_type, std::false_type) {return value.size();}
+
+        // length of a container followed by its elements
+        template<class T>
+        size_t ownSize(const T &value, std::false_type, std::true_type) {return sizeof(size_t) + elementsSize(value);}
+
+        template<class T>
+        size_t ownSize(const T &, std::false_type, std::false_type) {return sizeof(T);}
+    }
+
+    template<class T>
+    size_t messageSize(const T &value) {return detail::ownSize(value, detail::hasOwnSize<T>(), detail::isContainer<T>());}
+
+    template<class C, class R, class A>
+    size_t messageSize(const std::basic_string<C, R, A> &value) {return sizeof(size_t) + value.size() * sizeof(C);}
+
+    // the length of an array is part of its type so only the elements are sent
+    template<class T, size_t N>
+    size_t messageSize(const std::array<T, N> &value) {return detail::elementsSize(value);}
+
+    template<class T, class U>
+    size_t messageSize(const std::pair<T, U> &value) {return messageSize(value.first) + messageSize(value.second);}
+}
+
+#endif /* MessageSize_hpp */
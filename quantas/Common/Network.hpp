@@ -11,6 +11,63 @@ You should have received a copy of the GNU General Public License along with QUA
 // The underlaying data structure is a vector of peers(abstract class). It sets channel delays 
 // between peers when the network is initialized. These delays are between maximum and one. It 
 // is templated with a user defined message and peer class. 
+//
+// By default every pair of peers is given a channel. Setting "channels": "sparse" in the topology
+// only creates channels along the edges of the topology, neighbors added while the simulation runs
+// are connected at the end of the round, before messages are transmitted.
+//
+// For receiving and transmitting the peers are split into partitions of consecutive peers, one per
+// thread. Transmit puts the packets of a partition in its own outbox, grouped by the partition of
+// their target, and receive delivers the packets addressed to a partition from every outbox before
+// the peers in it receive. A thread only ever writes to the peers of its partition and to its own
+// outbox, so the phases need no locks and the order packets are delivered in does not depend on
+// thread timing.
+//
+// With work stealing enabled the computation of each partition is cut into chunks of consecutive
+// peers of about equal cost, using the time each peer took to compute in the previous rounds. A
+// worker computes the chunks of its own partition from the front and, once it has run out, takes
+// chunks from the back of partitions that have finished receiving. Peers that are expensive every
+// round, such as leaders, then no longer hold up the threads waiting on the end of the phase.
+//
+// With "activeSet" set in the experiment only the peers that are not idle are received, computed and
+// transmitted. A peer goes idle by calling idleUntil (see Peer) and is put back in the active set of its
+// partition in the round a packet arrives for it, in the round it asked for, or at the end of a round
+// in which it was woken or given packets to send. Skipped peers note that in an ActivityLog (see
+// NetworkInterface), so the end of a round does not visit every peer. Peers that never call idleUntil
+// are visited every round as before. The idle peers of a partition wait on a heap ordered by the round
+// they wake in, which only the thread receiving the partition touches. Work stealing is not used with the active set.
+// Idle peers are woken for the last round, so peers that report in it still do.
+//
+// With "eventDriven" set as well the clock skips the rounds in which nothing can happen: once every
+// active set is empty, nextRound moves it to the earliest round a packet arrives or an idle peer wakes
+// in (never past the last round). Skipped rounds are not run at all, endOfRound included, and their
+// number is logged for each test under "skippedRounds". Protocols whose peers spend most rounds
+// waiting on a timeout run in a fraction of the time.
+//
+// "speed" in the experiment gives peers different process speeds. After each step (receive, compute
+// and transmit) a peer draws the number of rounds until its next step from its distribution (see
+// Distribution, "default" applies to every peer and "peers" maps a peer id to its own), for example
+//  "speed": {"default": {"type": "UNIFORM", "maxDelay": 3}, "peers": {"0": {"type": "ONE"}}, "logRounds": true}
+// The speed model is part of the active set: a peer waits on the heap of its partition until its next
+// step, packets arriving before then wait on its wheel, so peers that are not scheduled cost nothing.
+// Every peer takes a step in round 0. The number of steps of each peer is logged for each test under
+// "steps" and, with "logRounds", the rounds each peer stepped in under "stepRounds".
+//
+// The "links" of the topology give channels a link model (see LinkModel). The models are kept by the
+// network and looked up when a channel is created, edges without their own model get the default one.
+//
+// With "countBytes" set in the experiment the network counts the bytes its peers send (see MessageSize)
+// and logs them for each test under "bytesSent" (per round), "bytesSentByPeer" and "bytesSentByChannel".
+//
+// The peers of a network are constructed in one block of memory, in the order of their ids. The
+// network knows their exact type, so the round loop calls performComputation and endOfRound without
+// going through the vtable and never needs a dynamic_cast. _peers keeps pointers to their Peer base,
+// in topology order, for the algorithms that are handed the list of peers. When the next test has as
+// many peers the block is kept and each peer is rebuilt in place, taking over the emptied channels,
+// streams and timing wheel of the peer it replaces, so setting up a test allocates little.
+//
+// A network belongs to one simulation context (see SimulationContext), which keeps its round and
+// the state its peers share. Peers are created in that context.
 
 
 #ifndef Network_hpp
@@ -27,9 +84,15 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <ctime>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <cstdint>
 #include <algorithm>
+#include <map>
+#include <new>
+#include <functional>
 #include "Peer.hpp"
 #include "Distribution.hpp"
+#include "LinkModel.hpp"
 
 namespace quantas{
 
@@ -48,15 +111,88 @@ namespace quantas{
     protected:
 
         vector<Peer<type_msg>*>             _peers;
+        vector<Peer<type_msg>*>             _peersById;         // peers indexed by their id
+        peer_type*                          _peerBlock;         // storage of the peers, peer i is constructed at index i
+        int                                 _peerCapacity;      // number of peers _peerBlock has room for
+        SimulationContext*                  _context;           // simulation the network is part of
         Distribution                        _distribution;
         ostream                             *_log;
+        bool                                _sparseChannels;    // only create channels between neighbors
+        vector<LinkModel>                   _links;             // link models of the topology
+        int                                 _defaultLink;       // index in _links of the model of channels without their own, -1 for none
+        std::map<std::pair<interfaceId, interfaceId>, int> _edgeLinks; // index in _links of the model of the channel from the first peer to the second
+        vector<int>                         _partitionBegin;    // index of the first peer of each partition, followed by the number of peers
+        vector<Outbox<type_msg> >           _outboxes;          // packets transmitted by each partition and not yet delivered
+        bool                                _countBytes;        // count the bytes sent by the peers
+        vector<vector<long> >               _roundBytes;        // bytes transmitted by each partition in each round
+
+        // chunks of a partition left to compute
+        struct ComputeQueue {
+            std::atomic<uint64_t>           range;              // first chunk left in the high half, one past the last in the low half
+            std::atomic<bool>               ready;              // the partition has received, its chunks may be stolen
+        };
+        static const int                    CHUNKS_PER_PARTITION = 8;
+        bool                                _workStealing;      // idle workers compute chunks of other partitions
+        vector<double>                      _computeCost;       // smoothed time in nanoseconds each peer took to compute
+        vector<std::pair<int, int> >        _chunks;            // [begin, end) peer ranges of every partition's chunks
+        vector<int>                         _chunkBegin;        // index of the first chunk of each partition, followed by the number of chunks
+        std::unique_ptr<ComputeQueue[]>     _computeQueues;     // one per partition
+
+        void                                planComputation     (); // cut the partitions into chunks for the next round
+        bool                                takeChunk           (int partition, bool fromBack, std::pair<int, int> &chunk);
+        void                                computeChunk        (const std::pair<int, int> &chunk);
+        void                                computeStealing     (int partition);
+
+        bool                                _activeSet;         // only visit the peers that are not idle
+        vector<vector<int> >                _active;            // indexes in _peers of the peers of each partition that are not idle, in order
+        vector<vector<std::pair<int, int> > > _wakeups;         // heap of the (round, index in _peers) the idle peers of each partition wake at, earliest first
+        vector<int>                         _wakeRound;         // round each idle peer wakes at, by index in _peers
+        vector<char>                        _scheduled;         // whether each peer is in the active set of its partition, by index in _peers
+        vector<int>                         _indexById;         // index in _peers of each peer id
+        ActivityLog                         _activity;          // skipped peers that were woken or given packets to send, looked at when the round ends
+        bool                                _eventDriven;       // skip the rounds in which nothing happens
+        int                                 _skippedRounds;     // rounds skipped in the current test
+
+        bool                                _speedModel;        // peers only step in the rounds drawn from their speed
+        bool                                _logStepRounds;     // log the rounds each peer stepped in
+        vector<Distribution>                _speeds;            // rounds between the steps of a peer
+        vector<int>                         _speedById;         // index in _speeds of the speed of each peer id, -1 to step every round
+        vector<int>                         _nextStep;          // round each peer steps in next, by index in _peers
+        vector<int>                         _steps;             // steps each peer took in the current test, by index in _peers
+        vector<vector<int> >                _stepRounds;        // rounds each peer stepped in, by index in _peers
+
+        // makes an idle peer wake no later than the given round
+        void                                wakeAt              (int partition, int index, int round);
+        // puts the idle peers that are due back in the active set of a partition
+        void                                wakeDue             (int partition);
+        // adds peers to the active set of a partition, keeping it in order
+        void                                activate            (int partition, vector<int> &indexes);
+        // earliest round from the current one on in which a peer is active or a packet arrives
+        int                                 nextEvent           ()const;
+        // records the step a peer took in the current round and draws the round of its next one
+        void                                scheduleStep        (int index);
+
+        // the peer at position i of _peers
+        peer_type*                          peer                (int i)const                                    {return static_cast<peer_type*>(_peers[i]);};
+        // makes room for count peers, destroying the current ones
+        void                                allocatePeers       (int count);
+        void                                destroyPeers        ();
+        // replaces the peer with the given id by a new one in the same place, which keeps the capacity
+        // of the old peer's channels and streams (see NetworkInterface::recycle)
+        peer_type*                          resetPeer           (int id);
 
         void                                addEdges            (Peer<type_msg>*);
+        void                                connect             (Peer<type_msg>*, Peer<type_msg>*);
+        void                                connectPending      ();
+        void                                setLinks            (json links);
+        // link model of the channel between two peers, nullptr for none
+        const LinkModel*                    linkFor             (interfaceId from, interfaceId to)const;
         peer_type*							getPeerById			(string);
 
     public:
         Network                                                 ();
-        Network                                                 (const Network<type_msg,peer_type>&);
+        // peers, channels and the per-partition queues point into the network, it is not copied
+        Network                                                 (const Network<type_msg,peer_type>&) = delete;
         ~Network                                                ();
 
         // setters
@@ -73,10 +209,21 @@ namespace quantas{
 	    void                                dynamic             (int, int);
         void                                setDistribution     (json distribution)                             { _distribution.setDistribution(distribution); }
         void                                setLog              (ostream&);
+        void                                setPartitions       (int); // split the peers into partitions for receive and transmit
+        void                                setContext          (SimulationContext *context)                    { _context = context; }
+        void                                setWorkStealing     (bool steal)                                    {_workStealing = steal;};
+        void                                setActiveSet        (bool active)                                   {_activeSet = active;};
+        // only takes effect together with the active set
+        void                                setEventDriven      (bool eventDriven)                              {_eventDriven = eventDriven;};
+        // speed model of the peers (null for every peer stepping every round), only takes effect together with the active set
+        void                                setSpeeds           (json speed);
+        void                                setCountBytes       (bool count);
         ostream*                            getLog              ()const                                         { return _log; }
 
         // getters
         int                                 size                ()const                                         {return (int)_peers.size();};
+        SimulationContext*                  context             ()const                                         {return _context;};
+        int                                 partitions          ()const                                         {return (int)_outboxes.size();};
         int                                 maxDelay            ()const                                         {return _distribution.maxDelay();};
         int                                 avgDelay            ()const                                         {return _distribution.avgDelay();};
         int                                 minDelay            ()const                                         {return _distribution.minDelay();};
@@ -84,10 +231,20 @@ namespace quantas{
 
 
         //mutators
-        void                                receive             (int begin, int end);
+        void                                receive             (int partition);
         void                                performComputation  (int begin, int end);
+        // receive followed by performComputation for the peers of one partition
+        void                                receiveAndCompute   (int partition);
         void                                endOfRound          ();
-        void                                transmit            (int begin, int end);
+        // round to run after the current one has transmitted, event driven networks skip the rounds in which nothing happens
+        int                                 nextRound           ();
+        // adds the bytes sent in the test to the log
+        void                                logBytes            ();
+        // adds the number of rounds skipped in the test to the log
+        void                                logSkippedRounds    ();
+        // adds the steps the peers took in the test to the log
+        void                                logSteps            ();
+        void                                transmit            (int partition);
         void                                makeRequest         (int i)                                         {_peers[i]->makeRequest();};
         void                                incrementRound();
         void                                initializeRound();
@@ -98,7 +255,7 @@ namespace quantas{
         void                                log                 ()const                                         {printTo(*_log);};
 
         // operators
-        Network&                            operator=           (const Network&);
+        Network&                            operator=           (const Network&) = delete;
         peer_type*                          operator[]          (int);
         const peer_type*                    operator[]          (int)const;
         friend ostream&                     operator<<          (ostream &out, const Network &system)      {return system.printTo(out);};
@@ -109,66 +266,321 @@ namespace quantas{
     template<class type_msg, class peer_type>
     Network<type_msg,peer_type>::Network(){
         _peers = vector<Peer<type_msg>*>();
+        _peerBlock = nullptr;
+        _peerCapacity = 0;
         _distribution = Distribution();
         _log = &cout;
+        _context = SimulationContext::current();
+        _sparseChannels = false;
+        _countBytes = false;
+        _defaultLink = -1;
+        _workStealing = false;
+        _activeSet = false;
+        _eventDriven = false;
+        _skippedRounds = 0;
+        _speedModel = false;
+        _logStepRounds = false;
     }
 
     template<class type_msg, class peer_type>
-    Network<type_msg,peer_type>::Network(const Network<type_msg,peer_type> &rhs){
-        if(this == &rhs){
-            return;
-        }
+    Network<type_msg,peer_type>::~Network(){
+        destroyPeers();
+    }
 
-        for(int i = 0; i < _peers.size(); i++){
-            delete _peers[i];
-        }
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::allocatePeers(int count){
+        destroyPeers();
+        _peerBlock = std::allocator<peer_type>().allocate(count);
+        _peerCapacity = count;
+    }
 
-        _peers = vector<Peer<type_msg>*>();
-        for(int i = 0; i < rhs._peers.size(); i++){
-            _peers.push_back(new peer_type(*dynamic_cast<peer_type*>(rhs._peers[i])));
-        }
-        _distribution = rhs.distribution;
-        _log = rhs._log;
+    template<class type_msg, class peer_type>
+    peer_type* Network<type_msg,peer_type>::resetPeer(int id){
+        NetworkInterface<type_msg> buffers;
+        buffers.recycle(_peerBlock[id]);
+        _peerBlock[id].~peer_type();
+        peer_type *fresh = new (&_peerBlock[id]) peer_type(id);
+        fresh->recycle(buffers);
+        return fresh;
     }
 
     template<class type_msg, class peer_type>
-    Network<type_msg,peer_type>::~Network(){
+    void Network<type_msg,peer_type>::destroyPeers(){
+        // every peer in _peers was constructed in the block at the index of its id
         for(int i = 0; i < _peers.size(); i++){
-            delete _peers[i];
+            peer(i)->~peer_type();
         }
+        _peers.clear();
+        _peersById.clear();
+        if (_peerBlock != nullptr) {
+            std::allocator<peer_type>().deallocate(_peerBlock, _peerCapacity);
+        }
+        _peerBlock = nullptr;
+        _peerCapacity = 0;
     }
 
     template<class type_msg, class peer_type>
     void Network<type_msg,peer_type>::setLog(ostream &out){
         _log = &out;
         for(int i = 0; i < _peers.size(); i++){
-            peer_type *p = dynamic_cast<peer_type*>(_peers[i]);
-            p->setLogFile(out);
+            peer(i)->setLogFile(out);
         }
 	}
 
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::setPartitions(int count){
+        if (count < 1) {
+            count = 1;
+        }
+        if (count > (int)_peers.size() && !_peers.empty()) {
+            count = (int)_peers.size();
+        }
+        _partitionBegin = vector<int>(count + 1);
+        for (int p = 0; p <= count; p++) {
+            _partitionBegin[p] = (int)(((long)p * _peers.size()) / count);
+        }
+        for (int p = 0; p < count; p++) {
+            for (int i = _partitionBegin[p]; i < _partitionBegin[p + 1]; i++) {
+                _peers[i]->setPartition(p);
+            }
+        }
+        // packets still in an old outbox are dropped, their targets may no longer exist
+        _outboxes = vector<Outbox<type_msg> >(count, Outbox<type_msg>(count));
+        _roundBytes = vector<vector<long> >(count);
+
+        _computeCost = vector<double>(_peers.size(), 1.0);
+        _computeQueues.reset(new ComputeQueue[count]);
+
+        // every peer starts in the active set
+        _active = vector<vector<int> >(count);
+        for (int p = 0; p < count; p++) {
+            for (int i = _partitionBegin[p]; i < _partitionBegin[p + 1]; i++) {
+                _active[p].push_back(i);
+            }
+        }
+        _wakeups = vector<vector<std::pair<int, int> > >(count);
+        _wakeRound = vector<int>(_peers.size(), Peer<type_msg>::NEVER);
+        _scheduled = vector<char>(_peers.size(), 1);
+        _activity.ids.clear();
+        for (int i = 0; i < _peers.size(); i++) {
+            _peers[i]->watchActivity(nullptr);
+        }
+        _indexById = vector<int>(_peers.size());
+        for (int i = 0; i < _peers.size(); i++) {
+            _indexById[_peers[i]->id()] = i;
+        }
+        _nextStep = vector<int>(_peers.size(), 0);
+        _steps = vector<int>(_peers.size(), 0);
+        _stepRounds = vector<vector<int> >(_logStepRounds ? _peers.size() : 0);
+        planComputation();
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::planComputation(){
+        _chunks.clear();
+        _chunkBegin = vector<int>(partitions() + 1);
+        for (int p = 0; p < partitions(); p++) {
+            _chunkBegin[p] = (int)_chunks.size();
+            int begin = _partitionBegin[p];
+            int end = _partitionBegin[p + 1];
+            double total = 0;
+            for (int i = begin; i < end; i++) {
+                total += _computeCost[i];
+            }
+            // close a chunk once it holds its share of the partition's cost
+            double share = total / CHUNKS_PER_PARTITION;
+            double cost = 0;
+            int first = begin;
+            for (int i = begin; i < end; i++) {
+                cost += _computeCost[i];
+                if (cost >= share || i == end - 1) {
+                    _chunks.push_back(std::make_pair(first, i + 1));
+                    first = i + 1;
+                    cost = 0;
+                }
+            }
+            int count = (int)_chunks.size() - _chunkBegin[p];
+            _computeQueues[p].range.store((uint64_t)count, std::memory_order_relaxed);
+            _computeQueues[p].ready.store(false, std::memory_order_relaxed);
+        }
+        _chunkBegin[partitions()] = (int)_chunks.size();
+    }
+
+    template<class type_msg, class peer_type>
+    bool Network<type_msg,peer_type>::takeChunk(int partition, bool fromBack, std::pair<int, int> &chunk){
+        std::atomic<uint64_t> &range = _computeQueues[partition].range;
+        uint64_t current = range.load(std::memory_order_relaxed);
+        while (true) {
+            uint32_t front = (uint32_t)(current >> 32);
+            uint32_t back = (uint32_t)current;
+            if (front >= back) {
+                return false;
+            }
+            uint32_t taken = fromBack ? back - 1 : front;
+            uint64_t next = fromBack ? ((uint64_t)front << 32) | (back - 1) : ((uint64_t)(front + 1) << 32) | back;
+            if (range.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                chunk = _chunks[_chunkBegin[partition] + taken];
+                return true;
+            }
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::computeChunk(const std::pair<int, int> &chunk){
+        for (int i = chunk.first; i < chunk.second; i++) {
+            _context->useStream(SimulationContext::COMPUTE, _peers[i]->id());
+            auto start = std::chrono::steady_clock::now();
+            peer(i)->peer_type::performComputation();
+            std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+            // weigh the last round as much as all the rounds before it
+            _computeCost[i] = (_computeCost[i] + took.count()) / 2;
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::computeStealing(int partition){
+        _computeQueues[partition].ready.store(true, std::memory_order_release);
+        std::pair<int, int> chunk;
+        while (takeChunk(partition, false, chunk)) {
+            computeChunk(chunk);
+        }
+        // help partitions that have received, the others are computed by their own worker
+        bool stole = true;
+        while (stole) {
+            stole = false;
+            for (int offset = 1; offset < partitions(); offset++) {
+                int victim = (partition + offset) % partitions();
+                if (!_computeQueues[victim].ready.load(std::memory_order_acquire)) {
+                    continue;
+                }
+                while (takeChunk(victim, true, chunk)) {
+                    computeChunk(chunk);
+                    stole = true;
+                }
+            }
+        }
+    }
+
 	template<class type_msg, class peer_type>
 	void Network<type_msg, peer_type>::addEdges(Peer<type_msg>* peer) {
+		vector<int> delays(_peers.size() - 1);
+		_distribution.getDelays(delays.data(), (int)delays.size());
 		for (int i = 0; i < _peers.size() - 1; i++) {
-			int delay = _distribution.getDelay();
-            
-			
             // Both directions have the same delay
-			peer->addChannel(*_peers[i], delay);
-			_peers[i]->addChannel(*peer, delay);
+			peer->addChannel(*_peers[i], delays[i], linkFor(peer->id(), _peers[i]->id()));
+			_peers[i]->addChannel(*peer, delays[i], linkFor(_peers[i]->id(), peer->id()));
 		}
 	}
 
+    // Creates the channels in both directions between two peers if they do not already exist
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::connect(Peer<type_msg>* a, Peer<type_msg>* b) {
+        if (a->hasChannel(b->id()) && b->hasChannel(a->id())) {
+            return;
+        }
+        int delay;
+        if (a->hasChannel(b->id())) {
+            delay = a->getDelayToNeighbor(b->id());
+        }
+        else if (b->hasChannel(a->id())) {
+            delay = b->getDelayToNeighbor(a->id());
+        }
+        else {
+            delay = _distribution.getDelay();
+        }
+
+        // Both directions have the same delay
+        if (!a->hasChannel(b->id())) {
+            a->addChannel(*b, delay, linkFor(a->id(), b->id()));
+        }
+        if (!b->hasChannel(a->id())) {
+            b->addChannel(*a, delay, linkFor(b->id(), a->id()));
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::setLinks(json links) {
+        _links.clear();
+        _edgeLinks.clear();
+        _defaultLink = -1;
+        if (links.is_null()) {
+            return;
+        }
+        // channels point into _links, so every model is added before the first channel is created
+        _links.reserve(1 + (links.contains("edges") ? links["edges"].size() : 0));
+        if (links.contains("default")) {
+            _defaultLink = (int)_links.size();
+            _links.push_back(LinkModel());
+            _links.back().setLinkModel(links["default"]);
+        }
+        if (links.contains("edges")) {
+            for (json edge : links["edges"]) {
+                int index = (int)_links.size();
+                _links.push_back(LinkModel());
+                _links.back().setLinkModel(edge);
+                interfaceId from = edge["from"];
+                interfaceId to = edge["to"];
+                _edgeLinks[std::make_pair(from, to)] = index;
+                if (!(edge.contains("directed") && edge["directed"] == true)) {
+                    _edgeLinks[std::make_pair(to, from)] = index;
+                }
+            }
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    const LinkModel* Network<type_msg, peer_type>::linkFor(interfaceId from, interfaceId to)const {
+        if (!_edgeLinks.empty()) {
+            auto it = _edgeLinks.find(std::make_pair(from, to));
+            if (it != _edgeLinks.end()) {
+                return &_links[it->second];
+            }
+        }
+        return _defaultLink == -1 ? nullptr : &_links[_defaultLink];
+    }
+
+    // Creates the channels for neighbors that were added without one
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::connectPending() {
+        for (int i = 0; i < _peers.size(); i++) {
+            const vector<interfaceId>& pending = _peers[i]->pendingChannels();
+            for (int j = 0; j < pending.size(); j++) {
+                if (pending[j] < 0 || pending[j] >= _peersById.size()) {
+                    continue;
+                }
+                connect(_peers[i], _peersById[pending[j]]);
+            }
+            _peers[i]->clearPendingChannels();
+        }
+    }
+
 	template<class type_msg, class peer_type>
 	void Network<type_msg, peer_type>::initNetwork(json topology, int lastRound) {
-	    for (int i = 0; i < _peers.size(); i++) {
-            delete _peers[i];
+        // peers are created in the network's context
+        SimulationContext::Scope scope(_context);
+        // setting up the network and the parameters draws from the setup stream of the test
+        _context->setRound(0);
+        _skippedRounds = 0;
+        _context->useStream(SimulationContext::SETUP);
+        const int totalPeers = topology["totalPeers"];
+        // the next test of a network of the same size rebuilds its peers in place
+        const bool reuse = _peerBlock != nullptr && _peerCapacity == totalPeers && (int)_peers.size() == totalPeers;
+        if (reuse) {
+            _peers.clear();
         }
-        _peers = vector<Peer<type_msg>*>();
-		for (int i = 0; i < topology["totalPeers"]; i++) {
-			_peers.push_back(new peer_type(i));
-			addEdges(_peers[i]);
+        else {
+            allocatePeers(totalPeers);
+        }
+        _sparseChannels = topology.contains("channels") && topology["channels"] == "sparse";
+        setLinks(topology.contains("links") ? topology["links"] : json());
+		for (int i = 0; i < totalPeers; i++) {
+			_peers.push_back(reuse ? resetPeer(i) : new (&_peerBlock[i]) peer_type(i));
+            _peers[i]->setCountBytes(_countBytes);
+			if (!_sparseChannels) {
+				addEdges(_peers[i]);
+			}
 		}
+        _peersById = _peers;
         if (topology["identifiers"] == "random") {
             // randomly shuffle nodes prior to setting up topology
             std::shuffle(_peers.begin(),_peers.end(), RANDOM_GENERATOR);
@@ -204,13 +616,16 @@ namespace quantas{
         else {
             std::cerr << "Error: need an input file" << std::endl;
         }
-        Peer<type_msg>::initializeRound();
-	    Peer<type_msg>::initializeLastRound(lastRound -1);
+        connectPending();
+        setPartitions(partitions());
+	    _context->setLastRound(lastRound -1);
 	}
 	
     template<class type_msg, class peer_type>
     void Network<type_msg, peer_type>::initParameters(json parameters) {
+        SimulationContext::Scope scope(_context);
         _peers[0]->initParameters(_peers, parameters);
+        connectPending();
     }
 
     template<class type_msg, class peer_type>
@@ -348,7 +763,7 @@ namespace quantas{
     // addNeighbor() adds peer to peer's _neighbors vector. I.e., it determines who the peer can broadcast to.
     template<class type_msg, class peer_type>
     void Network<type_msg, peer_type>::dynamic(int numberOfPeers, int sourcePoolSize) {
-        Peer<type_msg>::initializeSourcePoolSize(sourcePoolSize);
+        _context->setSourcePoolSize(sourcePoolSize);
         for (int i = 0; i < numberOfPeers; ++i) {
             for (int j = i + 1; j < numberOfPeers; ++j) {
                 if (j >= sourcePoolSize && !(i >= sourcePoolSize)) { // if peer[j] isn't apart of the source pool but peer[i] is...
@@ -364,8 +779,27 @@ namespace quantas{
     }
 
     template<class type_msg, class peer_type>
-    void Network<type_msg,peer_type>::receive(int begin, int end){
-        for (int i = begin; i < end; i++) {
+    void Network<type_msg,peer_type>::receive(int partition){
+        for (int sender = 0; sender < _outboxes.size(); sender++) {
+            vector<Delivery<type_msg> > &inbound = _outboxes[sender][partition];
+            for (int i = 0; i < inbound.size(); i++) {
+                if (_activeSet) {
+                    // an idle target wakes in the round the packet arrives
+                    const Packet<type_msg> &packet = inbound[i].packet;
+                    wakeAt(partition, _indexById[inbound[i].target->id()], std::max(packet.getRound() + packet.getDelay(), _context->round()));
+                }
+                inbound[i].target->deliver(std::move(inbound[i].packet));
+            }
+            inbound.clear();
+        }
+        if (_activeSet) {
+            wakeDue(partition);
+            for (int i : _active[partition]) {
+                _peers[i]->receive();
+            }
+            return;
+        }
+        for (int i = _partitionBegin[partition]; i < _partitionBegin[partition + 1]; i++) {
 		    _peers[i]->receive();
 	    }
     }
@@ -373,71 +807,356 @@ namespace quantas{
     template<class type_msg, class peer_type>
     void Network<type_msg,peer_type>::performComputation(int begin, int end){
         for (int i = begin; i < end; i++) {
-            _peers[i]->performComputation();
+            _context->useStream(SimulationContext::COMPUTE, _peers[i]->id());
+            peer(i)->peer_type::performComputation();
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::wakeAt(int partition, int index, int round){
+        // a peer never steps before the round its speed allows
+        round = std::max(round, _nextStep[index]);
+        if (_scheduled[index] || round >= _wakeRound[index]) {
+            return;
+        }
+        _wakeRound[index] = round;
+        vector<std::pair<int, int> > &heap = _wakeups[partition];
+        heap.push_back(std::make_pair(round, index));
+        std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int> >());
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::wakeDue(int partition){
+        const int round = _context->round();
+        vector<std::pair<int, int> > &heap = _wakeups[partition];
+        vector<int> woken;
+        while (!heap.empty() && heap.front().first <= round) {
+            int index = heap.front().second;
+            std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int> >());
+            heap.pop_back();
+            // entries left behind by a peer that woke earlier are skipped
+            if (!_scheduled[index] && _wakeRound[index] <= round) {
+                _peers[index]->watchActivity(nullptr);
+                peer(index)->wake();
+                woken.push_back(index);
+            }
+        }
+        if (round == _context->lastRound()) {
+            for (int i = _partitionBegin[partition]; i < _partitionBegin[partition + 1]; i++) {
+                if (!_scheduled[i] && _wakeRound[i] > round && _nextStep[i] <= round) {
+                    _peers[i]->watchActivity(nullptr);
+                    peer(i)->wake();
+                    woken.push_back(i);
+                }
+            }
+        }
+        activate(partition, woken);
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::activate(int partition, vector<int> &indexes){
+        if (indexes.empty()) {
+            return;
+        }
+        vector<int> &active = _active[partition];
+        const size_t before = active.size();
+        for (int index : indexes) {
+            _peers[index]->watchActivity(nullptr);
+            _scheduled[index] = 1;
+            _wakeRound[index] = Peer<type_msg>::NEVER;
+            active.push_back(index);
+        }
+        std::sort(active.begin() + before, active.end());
+        std::inplace_merge(active.begin(), active.begin() + before, active.end());
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::receiveAndCompute(int partition){
+        receive(partition);
+        if (_activeSet) {
+            for (int i : _active[partition]) {
+                _context->useStream(SimulationContext::COMPUTE, _peers[i]->id());
+                peer(i)->peer_type::performComputation();
+            }
+        }
+        else if (_workStealing) {
+            computeStealing(partition);
+        }
+        else {
+            performComputation(_partitionBegin[partition], _partitionBegin[partition + 1]);
         }
     }
 
     template<class type_msg, class peer_type>
     void Network<type_msg, peer_type>::endOfRound() {
-        _peers[0]->endOfRound(_peers);
-        Peer<type_msg>::incrementRound();
+        _context->useStream(SimulationContext::END_OF_ROUND);
+        peer(0)->peer_type::endOfRound(_peers);
+        // neighbors added during the round need a channel before transmitting
+        connectPending();
+        if (_workStealing) {
+            planComputation();
+        }
+        _context->setRound(_context->round() + 1);
+        if (_activeSet) {
+            // skipped peers woken or given packets to send during the round transmit with the others, or in
+            // their next step when they may not step in the round that ended. Only the peers that noted
+            // themselves in the activity log are looked at.
+            const int ended = _context->round() - 1;
+            vector<vector<int> > woken(partitions());
+            for (interfaceId id : _activity.ids) {
+                int i = _indexById[id];
+                int p = _peers[i]->partition();
+                if (_scheduled[i]) {
+                    continue;
+                }
+                if (!peer(i)->idle() || !_peers[i]->outStreamEmpty()) {
+                    peer(i)->wake();
+                    if (_nextStep[i] > ended) {
+                        wakeAt(p, i, _nextStep[i]);
+                        _peers[i]->watchActivity(&_activity);
+                    }
+                    else {
+                        woken[p].push_back(i);
+                    }
+                }
+                else {
+                    // still idle, possibly until another round
+                    wakeAt(p, i, std::min(peer(i)->idleRound(), _peers[i]->nextArrival()));
+                    _peers[i]->watchActivity(&_activity);
+                }
+            }
+            _activity.ids.clear();
+            for (int p = 0; p < partitions(); p++) {
+                activate(p, woken[p]);
+            }
+        }
     }
 
     template<class type_msg, class peer_type>
-    void Network<type_msg,peer_type>::transmit(int begin, int end){
-        for (int i = begin; i < end; i++) {
-            _peers[i]->transmit();
+    void Network<type_msg,peer_type>::transmit(int partition){
+        long bytes = 0;
+        if (_activeSet) {
+            // peers that went idle while computing, or do not step in the next round, leave the active set
+            // once they have transmitted
+            const int next = _context->round();
+            vector<int> &active = _active[partition];
+            size_t kept = 0;
+            for (size_t k = 0; k < active.size(); k++) {
+                int i = active[k];
+                _context->useStream(SimulationContext::TRANSMIT, _peers[i]->id());
+                bytes += _peers[i]->transmit(_outboxes[partition]);
+                if (_speedModel) {
+                    scheduleStep(i);
+                }
+                if (peer(i)->idle()) {
+                    _scheduled[i] = 0;
+                    // packets a peer sent to itself skip the wheel, they are read in the next round
+                    int wake = _peers[i]->inStreamEmpty() ? std::min(peer(i)->idleRound(), _peers[i]->nextArrival()) : next;
+                    wakeAt(partition, i, wake);
+                    _peers[i]->watchActivity(&_activity);
+                }
+                else if (_nextStep[i] > next) {
+                    _scheduled[i] = 0;
+                    wakeAt(partition, i, _nextStep[i]);
+                    _peers[i]->watchActivity(&_activity);
+                }
+                else {
+                    active[kept++] = i;
+                }
+            }
+            active.resize(kept);
+        }
+        else {
+            for (int i = _partitionBegin[partition]; i < _partitionBegin[partition + 1]; i++) {
+                _context->useStream(SimulationContext::TRANSMIT, _peers[i]->id());
+                bytes += _peers[i]->transmit(_outboxes[partition]);
+            }
+        }
+        if (_countBytes) {
+            _roundBytes[partition].push_back(bytes);
         }
     }
 
     template<class type_msg, class peer_type>
-    ostream& Network<type_msg,peer_type>::printTo(ostream &out)const{
-        out<< "--- NETWROK SETUP ---"<< endl<< endl;
-        out<< left;
-        out<< '\t'<< setw(LOG_WIDTH)<< "Number of Peers"<< setw(LOG_WIDTH)<< "Distribution"<< setw(LOG_WIDTH)<< "Min Delay"<< setw(LOG_WIDTH)<< "Average Delay"<< setw(LOG_WIDTH)<< "Max Delay"<< endl;
-        out<< '\t'<< setw(LOG_WIDTH)<< _peers.size()<< setw(LOG_WIDTH)<< type() << setw(LOG_WIDTH)<< minDelay() << setw(LOG_WIDTH)<< avgDelay()<< setw(LOG_WIDTH)<< maxDelay() << endl;
+    int Network<type_msg,peer_type>::nextEvent()const{
+        int next = Peer<type_msg>::NEVER;
+        for (int p = 0; p < partitions(); p++) {
+            if (!_active[p].empty()) {
+                return _context->round();
+            }
+            // entries of peers that already woke only make the clock stop early
+            if (!_wakeups[p].empty()) {
+                next = std::min(next, _wakeups[p].front().first);
+            }
+        }
+        // packets transmitted this round are not yet on the wheels of their targets
+        for (int sender = 0; sender < partitions(); sender++) {
+            for (int p = 0; p < partitions(); p++) {
+                for (const Delivery<type_msg> &delivery : _outboxes[sender][p]) {
+                    next = std::min(next, delivery.packet.getRound() + delivery.packet.getDelay());
+                }
+            }
+        }
+        return next;
+    }
 
-        for(int i = 0; i < _peers.size(); i++){
-            peer_type *p = dynamic_cast<peer_type*>(_peers[i]);
-            p->printTo(out);
+    template<class type_msg, class peer_type>
+    int Network<type_msg,peer_type>::nextRound(){
+        const int next = _context->round();
+        if (!_eventDriven || !_activeSet || next >= _context->lastRound()) {
+            return next;
+        }
+        const int event = std::min(nextEvent(), _context->lastRound());
+        if (event <= next) {
+            return next;
+        }
+        _skippedRounds += event - next;
+        if (_countBytes) {
+            // nothing is sent in the skipped rounds
+            for (int p = 0; p < partitions(); p++) {
+                _roundBytes[p].insert(_roundBytes[p].end(), event - next, 0);
+            }
         }
+        _context->setRound(event);
+        return event;
+    }
 
-        return out;
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::setSpeeds(json speed){
+        _speeds.clear();
+        _speedById = vector<int>(_peersById.size(), -1);
+        _speedModel = !speed.is_null();
+        _logStepRounds = _speedModel && speed.contains("logRounds") && speed["logRounds"] == true;
+        if (!_speedModel) {
+            return;
+        }
+        if (speed.contains("default")) {
+            _speeds.push_back(Distribution());
+            _speeds.back().setDistribution(speed["default"]);
+            std::fill(_speedById.begin(), _speedById.end(), 0);
+        }
+        if (speed.contains("peers")) {
+            for (auto &entry : speed["peers"].items()) {
+                int id = std::stoi(entry.key());
+                if (id < 0 || id >= (int)_speedById.size()) {
+                    continue;
+                }
+                _speedById[id] = (int)_speeds.size();
+                _speeds.push_back(Distribution());
+                _speeds.back().setDistribution(entry.value());
+            }
+        }
     }
 
     template<class type_msg, class peer_type>
-    Network<type_msg, peer_type>& Network<type_msg,peer_type>::operator=(const Network<type_msg, peer_type> &rhs){
-        if(this == &rhs){
-            return *this;
+    void Network<type_msg,peer_type>::scheduleStep(int index){
+        // transmit runs after the round was advanced
+        const int round = _context->round() - 1;
+        ++_steps[index];
+        if (_logStepRounds) {
+            _stepRounds[index].push_back(round);
         }
+        const int speed = _speedById[_peers[index]->id()];
+        if (speed < 0) {
+            _nextStep[index] = round + 1;
+            return;
+        }
+        // the draw has a stream of its own, so it does not depend on what the peer sent
+        _context->useStream(SimulationContext::SCHEDULE, _peers[index]->id());
+        _nextStep[index] = round + _speeds[speed].getDelay();
+    }
 
-        for(int i = 0; i < _peers.size(); i++){
-            delete _peers[i];
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::setCountBytes(bool count){
+        _countBytes = count;
+        for (int i = 0; i < _peers.size(); i++) {
+            _peers[i]->setCountBytes(count);
         }
+    }
 
-        _peers = vector<Peer<type_msg>*>();
-        for(int i = 0; i < rhs._peers.size(); i++){
-            _peers.push_back(new peer_type(*dynamic_cast<peer_type*>(rhs._peers[i])));
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::logBytes(){
+        if (!_countBytes) {
+            return;
+        }
+        json &test = _context->log().data["tests"][_context->log().getTest()];
+        size_t rounds = 0;
+        for (int p = 0; p < partitions(); p++) {
+            rounds = std::max(rounds, _roundBytes[p].size());
+        }
+        for (size_t j = 0; j < rounds; j++) {
+            long bytes = 0;
+            for (int p = 0; p < partitions(); p++) {
+                bytes += j < _roundBytes[p].size() ? _roundBytes[p][j] : 0;
+            }
+            test["bytesSent"].push_back(bytes);
         }
+        for (int i = 0; i < _peersById.size(); i++) {
+            test["bytesSentByPeer"].push_back(_peersById[i]->bytesSent());
+            json channels = json::object();
+            for (interfaceId target : _peersById[i]->channels()) {
+                long bytes = _peersById[i]->bytesSentTo(target);
+                if (bytes > 0) {
+                    channels[std::to_string(target)] = bytes;
+                }
+            }
+            if (!channels.empty()) {
+                test["bytesSentByChannel"][std::to_string(_peersById[i]->id())] = channels;
+            }
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::logSkippedRounds(){
+        if (!_eventDriven || !_activeSet) {
+            return;
+        }
+        _context->log().data["tests"][_context->log().getTest()]["skippedRounds"] = _skippedRounds;
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::logSteps(){
+        if (!_speedModel || !_activeSet) {
+            return;
+        }
+        json &test = _context->log().data["tests"][_context->log().getTest()];
+        for (int id = 0; id < _peersById.size(); id++) {
+            test["steps"].push_back(_steps[_indexById[id]]);
+            if (_logStepRounds) {
+                test["stepRounds"].push_back(_stepRounds[_indexById[id]]);
+            }
+        }
+    }
 
-        return *this;
+    template<class type_msg, class peer_type>
+    ostream& Network<type_msg,peer_type>::printTo(ostream &out)const{
+        out<< "--- NETWROK SETUP ---"<< endl<< endl;
+        out<< left;
+        out<< '\t'<< setw(LOG_WIDTH)<< "Number of Peers"<< setw(LOG_WIDTH)<< "Distribution"<< setw(LOG_WIDTH)<< "Min Delay"<< setw(LOG_WIDTH)<< "Average Delay"<< setw(LOG_WIDTH)<< "Max Delay"<< endl;
+        out<< '\t'<< setw(LOG_WIDTH)<< _peers.size()<< setw(LOG_WIDTH)<< type() << setw(LOG_WIDTH)<< minDelay() << setw(LOG_WIDTH)<< avgDelay()<< setw(LOG_WIDTH)<< maxDelay() << endl;
+
+        for(int i = 0; i < _peers.size(); i++){
+            peer(i)->printTo(out);
+        }
+
+        return out;
     }
 
     template<class type_msg, class peer_type>
     peer_type* Network<type_msg,peer_type>::operator[](int i){
-        return dynamic_cast<peer_type*>(_peers[i]);
+        return peer(i);
     }
 
     template<class type_msg, class peer_type>
     const peer_type* Network<type_msg,peer_type>::operator[](int i)const{
-        return dynamic_cast<peer_type*>(_peers[i]);
+        return peer(i);
     }
 
     template<class type_msg, class peer_type>
     peer_type* Network<type_msg,peer_type>::getPeerById(string id){
         for(int i = 0; i<_peers.size(); i++){
             if(_peers[i]->id() ==  id)
-                return dynamic_cast<peer_type*>(_peers[i]);
+                return peer(i);
         }
         return nullptr;
     }
@@ -22,31 +22,59 @@ You should have received a copy of the GNU General Public License along with QUA
 //
 // === RECEIVING MESSAGES ===
 // Each instance of NetworkInterface has a list of its neighbors NetworkInterface ID <_neighbors>, 
-// and a hashmap <_inBoundChannels> with the ID of this NetworkInterface's neighbors as the key and a 
-// queue of inbound packets (or <aChannel>) as the value. When receive is called each packet in each 
-// channel has <<moveForward>> called. This decrements the delay on the packet (how many rounds the 
-// packet must wait until it's arrvied at it's target interface). Then the head of each channel has 
-// <<hasArrived>> called. This returns true is the packet has arrvied (delay == 0) and false otherwise.
-// If <<hasArrived>> is true then the packet is moved from the channel in <_inBoundChannels> to 
-// the NetworkInterface's <_inStream>. This repeats poping the head of the channel and pushing onto 
-// <_inStream> until a packet has not arrived. In this way all packets are received in the same order
-// they where sent. 
+// and a timing wheel <_arrivals> holding the packets that are on their way to this interface. The
+// wheel is a ring of buckets indexed by the round a packet arrives, modulo the number of buckets.
+// When receive is called only the bucket of the current round is visited. Each packet in it that
+// <<hasArrived>> (the round it was sent plus its delay has been reached) is moved to the
+// NetworkInterface's <_inStream>, packets that are due on a later lap of the wheel stay in the bucket.
+// Arrived packets are ordered by source id as they are pushed onto <_inStream>.
+//
+// <_inStream> and <_outStream> are flat arrays that keep their storage between rounds. The out stream
+// is emptied in one go by transmit, the in stream is read from <_inHead> and emptied once it has been
+// read to the end, so after the first rounds moving packets through an interface allocates nothing.
+//
+// An interface that is not received every round (see the active set of Network) takes the packets of
+// every round since it was last received, so packets wait on the wheel until it is received again.
+// While the network skips an interface it watches it through an ActivityLog: the first time the
+// interface is given packets to send (or its peer is woken) it notes its id there, so the network
+// only looks at the interfaces that were noted instead of every skipped one.
 //
 // Note: packets are received in the same order they where sent and only after all packets sent before
-// it have been received
+// it have been received. The sender guarantees this by never letting a packet arrive before the
+// previous packet it sent over the same channel.
 // 
 //
 // === TRANSMITING MESSAGES ===
-// Each instance of NetworkInterface has a list of references to it's neighbor's NetworkInterface 
-// and a list of the delays to thouse neighbor's interface. These are each stored in hashmaps with
-// the neighbor's NetworkInterface ID as the key and either the reference to the interface or delay 
-// as the value. The connection between interfaces is called a channel. When transmit is run on a 
+// Each instance of NetworkInterface has a flat array of channels <_channels>, one slot per interface
+// it is connected to. Each slot holds a reference to the neighbor's NetworkInterface, the delay to that
+// neighbor and the arrival round of the last packet sent to it. The slot of a target is found through
+// <_channelIndex>, a list of (id, slot) pairs sorted by id. When transmit is run on a 
 // peer derivitive each packet in the outStream is sent. When a packet is sent, the target ID of 
-// the packet is used to look up the referenced interface and the delay associated with that interface. 
+// the packet is used to look up the channel and the delay associated with it. 
 // The packet delay is set between 1 and the delay between the two interfaces (the delay on the channel)
-// The method <<SEND>> is then called on the neighbor's interface (not this object but the instance of 
-// NetworkInterface in the target peer). <<SEND>> pushes the packet into the _inBoundChannel of the 
-// tagets Peers networkInterface
+// The packet is then placed in the outbox of the sender's partition, in the list for the partition of
+// the target (see Network). Transmit never writes into another interface. At the start of the next
+// round the thread receiving a partition calls <<DELIVER>> on each of its interfaces for the packets
+// addressed to them, which inserts the packet into the bucket of the timing wheel for the round it
+// arrives. Every interface is only ever written by the thread that owns its partition, so no locking
+// is needed.
+//
+// === NEIGHBORS ===
+// <_neighbors> lists the neighbors in the order they were added, an interface is only listed once.
+// Membership is answered by the bitset <_neighborBits> indexed by interface id, so isNeighbor, which
+// transmit calls for every packet, takes constant time however many neighbors an interface has.
+//
+// === CHANNELS ===
+// By default the network creates a channel between every pair of interfaces. When the topology
+// requests sparse channels only the edges of the topology get one. Neighbors added afterwards
+// without a channel are kept in <_pendingChannels> until the network connects them.
+//
+// A channel can have a link model (see LinkModel) which replaces the delay of its packets and can
+// drop, duplicate, reorder or queue them. Packets queued by the bandwidth of a link leave in the
+// first round with room left and take their delay from then on.
+//
+// When counting bytes is turned on each interface adds up the size (see MessageSize) of the packets it
+// sends over each channel. transmit returns the bytes sent, which the network logs per round.
 //
 
 
@@ -62,7 +90,15 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <iomanip>
 #include <algorithm>
 #include <iterator>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <memory>
+#include <mutex>
 #include "Packet.hpp"
+#include "LinkModel.hpp"
+#include "MessageSize.hpp"
 
 namespace quantas{
 
@@ -82,6 +118,26 @@ namespace quantas{
     
     static const int  LOG_WIDTH  = 27;  // var used for column width in loggin
     typedef long      interfaceId;
+
+    template <class message>
+    class NetworkInterface;
+
+    // a packet waiting in an outbox to be delivered to its target
+    template <class message>
+    struct Delivery {
+        NetworkInterface<message>*                      target;
+        Packet<message>                                 packet;
+    };
+
+    // ids of the skipped interfaces that were given work, kept by the network (see watchActivity)
+    struct ActivityLog {
+        std::mutex                                      lock;
+        vector<interfaceId>                             ids;
+    };
+
+    // packets transmitted by one partition of the network, indexed by the partition of their target
+    template <class message>
+    using Outbox = vector<vector<Delivery<message> > >;
     //
     // Base Peer class
     //
@@ -89,18 +145,45 @@ namespace quantas{
     class NetworkInterface{
     private:
         
-        typedef deque<Packet<message> >                 aChannel;
+        // a connection with one other interface
+        struct aChannel {
+            interfaceId                                 id;          // id of the interface at the other end
+            NetworkInterface<message>*                  target;      // interface at the other end, use send to send it a message
+            int                                         delay;       // maximum delay of packets sent to the target
+            int                                         lastArrival; // round the last packet sent to the target arrives
+            const LinkModel*                            link;        // how packets are sent over the channel, nullptr for the default
+            int                                         queueRound;  // round the last packet queued for the link's bandwidth leaves in
+            int                                         queued;      // packets leaving in queueRound
+            int                                         byteRound;   // round the last packet queued for the link's bytes per round leaves in
+            long                                        queuedBytes; // bytes leaving in byteRound
+            long                                        bytes;       // bytes sent over the channel
+        };
 
         interfaceId                                     _id;
-        map<interfaceId,aChannel>                       _inBoundChannels;// channels from all other interfaces into this interface
-        map<interfaceId,int>                            _outBoundChannelDelays;// list of channels delays by there target interface id
-        map<interfaceId, NetworkInterface<message>* >   _outBoundChannels; // list of all other interfaces in the network (weather they are a neighbor or not) use send to send them a message
-        deque<Packet<message> >                         _inStream;// messages that have arrived at this peer
-        deque<Packet<message> >                         _outStream;// messages waiting to be sent by this peer
+        vector<aChannel>                                _channels; // channels to all other interfaces (weather they are a neighbor or not)
+        vector<std::pair<interfaceId, int> >            _channelIndex; // (id, slot in _channels) sorted by id
+        vector<vector<Packet<message> > >               _arrivals; // timing wheel of inbound packets, bucket i holds the packets arriving on rounds equal to i modulo its size
+        vector<Packet<message> >                        _inStream;// messages that have arrived at this peer, the ones before _inHead have been read
+        size_t                                          _inHead; // next message of _inStream to be read
+        int                                             _lastReceive; // round receive was last called in
+        vector<Packet<message> >                        _outStream;// messages waiting to be sent by this peer
         vector<interfaceId>                             _neighbors; // list of interfaces that are directly connected to this one (i.e. they can send messages directly to each other)
+        vector<uint64_t>                                _neighborBits; // bit id is set when the interface with that id is a neighbor
+        vector<interfaceId>                             _pendingChannels; // neighbors added without a channel, the network creates these channels
+        int                                             _partition; // partition of the network this interface is received and transmitted in
+        SimulationContext*                              _context; // simulation this interface is part of
+        bool                                            _countBytes; // whether the bytes sent are counted
+        long                                            _bytesSent; // bytes sent over all channels
+        ActivityLog*                                    _activityLog; // log the network watches this interface through while it skips it, nullptr otherwise
         
-         // send a message to this peer
-        void                               send                  (Packet<message>);
+        // slot of the channel to the interface with the given id, -1 if there is none
+        int                                channelIndex          (interfaceId id)const;
+        // grows the timing wheel so packets with the given delay do not wrap around it
+        void                               reserveArrivals       (int delay);
+        // moves the packets of a bucket of the wheel that have arrived by the given round to _inStream
+        void                               takeArrived           (vector<Packet<message> > &bucket, int round);
+        // sends a packet over a channel with a link model
+        void                               transmitOver          (aChannel &channel, Packet<message> &&packet, long bytes, Outbox<message> &outbox);
 
     protected:
         
@@ -122,34 +205,61 @@ namespace quantas{
         // Setters
         void                               setID                 (interfaceId id)                           {_id = id;};
         void                               setLogFile            (ostream &o)                               {_log = &o;};
+        void                               setPartition          (int partition)                            {_partition = partition;};
+        void                               setContext            (SimulationContext *context)               {_context = context;};
+        void                               setCountBytes         (bool count)                               {_countBytes = count;};
         void                               printNeighborhoodOn   ()                                         {_printNeighborhood = true;}
         void                               printNeighborhoodOff  ()                                         {_printNeighborhood = false;}
         
         // getters
-        vector<interfaceId>                neighbors             ()const                                    {return _neighbors;};
+        const vector<interfaceId>&         neighbors             ()const                                    {return _neighbors;};
         vector<interfaceId>                channels              ()const;                                   
         interfaceId                        id                    ()const                                    {return _id;};
+        int                                partition             ()const                                    {return _partition;};
+        SimulationContext*                 context               ()const                                    {return _context;};
         bool                               isNeighbor            (interfaceId id)const;
+        bool                               hasChannel            (interfaceId id)const                      {return channelIndex(id) != -1;};
+        const vector<interfaceId>&         pendingChannels       ()const                                    {return _pendingChannels;};
         int                                getDelayToNeighbor    (interfaceId id)const;
+        long                               bytesSent             ()const                                    {return _bytesSent;};
+        // bytes sent over the channel to an interface
+        long                               bytesSentTo           (interfaceId id)const;
         size_t                             outStreamSize         ()const                                    {return _outStream.size();};
-        size_t                             inStreamSize          ()const                                    {return _inStream.size();};
+        size_t                             inStreamSize          ()const                                    {return _inStream.size() - _inHead;};
         bool                               outStreamEmpty        ()const                                    {return _outStream.empty();};
-        bool                               inStreamEmpty         ()const                                    {return _inStream.empty();};
+        bool                               inStreamEmpty         ()const                                    {return _inHead == _inStream.size();};
 
         // mutators
-        void                               removeChannel         (const NetworkInterface &neighbor)         {_outBoundChannels.erase(neighbor);};
-        void                               addChannel            (NetworkInterface &newNeighbor, int delay);
+        void                               removeChannel         (const NetworkInterface &neighbor);
+        void                               addChannel            (NetworkInterface &newNeighbor, int delay, const LinkModel *link = nullptr);
         void                               clearMessages         ();
-        void                               pushToOutSteam        (Packet<message> outMsg)                   {_outStream.push_back(outMsg);};
+        // takes the buffers of an interface that is being replaced, emptied but with their capacity, for the
+        // ones this interface has not started using
+        void                               recycle               (NetworkInterface &old);
+        void                               pushToOutStream       (const Packet<message> &outMsg)            {noteActivity(); _outStream.push_back(outMsg);};
+        void                               pushToOutStream       (Packet<message> &&outMsg)                 {noteActivity(); _outStream.push_back(std::move(outMsg));};
+        // misspelled name kept for existing algorithms
+        void                               pushToOutSteam        (const Packet<message> &outMsg)            {noteActivity(); _outStream.push_back(outMsg);};
+        void                               pushToOutSteam        (Packet<message> &&outMsg)                 {noteActivity(); _outStream.push_back(std::move(outMsg));};
+        // makes the interface note its id in the log the next time it is given work, nullptr to stop watching it
+        void                               watchActivity         (ActivityLog *log)                         {_activityLog = log;};
+        // notes the interface in the log it is watched through, once
+        void                               noteActivity          ();
         Packet<message>                    popInStream           ();
-        void                               addNeighbor           (interfaceId neighborIdAdd)                {_neighbors.push_back(neighborIdAdd);};
+        void                               addNeighbor           (interfaceId neighborIdAdd);
+        void                               clearPendingChannels  ()                                         {_pendingChannels.clear();};
         void                               removeNeighbor        (interfaceId neighborIdToRemove);
 
+        // puts a packet taken from an outbox on this interface's timing wheel, called from the thread receiving its partition
+        void                               deliver               (Packet<message>&&);
         // moves msgs from the channel to the inStream if msg delay is 0 else decrease msg delay by 1
         void                               receive               ();
+        // round the first packet on its way to this interface arrives in, the largest int if there is none
+        int                                nextArrival           ()const;
        
-        // sends all messages in _outStream to there respective targets
-        void                               transmit              ();
+        // sends all messages in _outStream to there respective targets through the outbox of this interface's partition,
+        // returns the bytes sent if they are counted
+        long                               transmit              (Outbox<message> &outbox);
         
         void                               log                   ()const;
         ostream&                           printTo               (ostream&)const;
@@ -171,27 +281,32 @@ namespace quantas{
         friend ostream&                    operator<<            (ostream&, const NetworkInterface<messageType>&);
     };
 
+    // All broadcasts share a single copy of the message between the packets sent
     template <class message>
     void NetworkInterface<message>::broadcast(message msg){
+        noteActivity();
+        typename Packet<message>::SharedBody body = Packet<message>::makeBody(std::move(msg));
         for(auto it = _neighbors.begin(); it != _neighbors.end(); it++){
             Packet<message> outPacket = Packet<message>(-1);
             outPacket.setSource(id());
             outPacket.setTarget(*it);
-            outPacket.setMessage(msg);
-            _outStream.push_back(outPacket);
+            outPacket.setBody(body);
+            _outStream.push_back(std::move(outPacket));
         }
     }
 
     // Send to all neighbors except id
     template <class message>
     void NetworkInterface<message>::broadcastBut(message msg, long ident){
+        noteActivity();
+        typename Packet<message>::SharedBody body = Packet<message>::makeBody(std::move(msg));
         for(auto it = _neighbors.begin(); it != _neighbors.end(); it++){
             if(*it != ident) {
                 Packet<message> outPacket = Packet<message>(-1);
                 outPacket.setSource(id());
                 outPacket.setTarget(*it);
-                outPacket.setMessage(msg);
-                _outStream.push_back(outPacket);
+                outPacket.setBody(body);
+                _outStream.push_back(std::move(outPacket));
             }
         }
     }
@@ -199,33 +314,34 @@ namespace quantas{
     // Send to a single neighbor, here the first one
     template <class message>
     void NetworkInterface<message>::unicast(message msg){
+        noteActivity();
         auto it = _neighbors.begin();
         if (_neighbors.size()>0) {
             Packet<message> outPacket = Packet<message>(-1);
             outPacket.setSource(id());
             outPacket.setTarget(*it);
-            outPacket.setMessage(msg);
-            _outStream.push_back(outPacket);
+            outPacket.setMessage(std::move(msg));
+            _outStream.push_back(std::move(outPacket));
         }
     }
     
     // Send to a single designated neighbor
     template <class message>
     void NetworkInterface<message>::unicastTo(message msg, long dest){
-        for(auto it = _neighbors.begin(); it != _neighbors.end(); it++){
-            if(*it == dest) {
-                Packet<message> outPacket = Packet<message>(-1);
-                outPacket.setSource(id());
-                outPacket.setTarget(*it);
-                outPacket.setMessage(msg);
-                _outStream.push_back(outPacket);
-            }
+        noteActivity();
+        if(isNeighbor(dest)) {
+            Packet<message> outPacket = Packet<message>(-1);
+            outPacket.setSource(id());
+            outPacket.setTarget(dest);
+            outPacket.setMessage(std::move(msg));
+            _outStream.push_back(std::move(outPacket));
         }
     }
     
     // Multicasts to a random sample of neighbors without repetition. Size of sample is also random.
     template <class message>
     void NetworkInterface<message>::randomMulticast(message msg) {
+        noteActivity();
        
         // interval: [0, n], where n is the amount of neighbors the particular node calling this function has
         int amountOfNeighbors = uniformInt(0, _neighbors.size());
@@ -239,23 +355,31 @@ namespace quantas{
             RANDOM_GENERATOR
         );
 
+        typename Packet<message>::SharedBody body = Packet<message>::makeBody(std::move(msg));
         for (auto it = out.begin(); it != out.end(); ++it) { // iterate through vector where the samples are written and send a message to all of them
             Packet<message> outPacket = Packet<message>(-1);
             outPacket.setSource(id());
             outPacket.setTarget(*it);
-            outPacket.setMessage(msg);
-            _outStream.push_back(outPacket);
+            outPacket.setBody(body);
+            _outStream.push_back(std::move(outPacket));
         }
     }
 	
     template <class message>
     NetworkInterface<message>::NetworkInterface(){
         _id = NO_PEER_ID;
-        _inStream = deque<Packet<message> >();
-        _outStream = deque<Packet<message> >();
-        _outBoundChannels = map<interfaceId, NetworkInterface<message>* >();
-        _outBoundChannelDelays = map<interfaceId,int>();
-        _inBoundChannels = map<interfaceId,aChannel>();
+        _inStream = vector<Packet<message> >();
+        _inHead = 0;
+        _lastReceive = -1;
+        _outStream = vector<Packet<message> >();
+        _channels = vector<aChannel>();
+        _channelIndex = vector<std::pair<interfaceId, int> >();
+        _arrivals = vector<vector<Packet<message> > >(2);
+        _partition = 0;
+        _countBytes = false;
+        _bytesSent = 0;
+        _activityLog = nullptr;
+        _context = SimulationContext::current();
         _log = &cout;
         _printNeighborhood = false;
     }
@@ -263,121 +387,405 @@ namespace quantas{
     template <class message>
     NetworkInterface<message>::NetworkInterface(interfaceId id){
         _id = id;
-        _inStream = deque<Packet<message> >();
-        _outStream = deque<Packet<message> >();
-        _outBoundChannels = map<interfaceId, NetworkInterface<message>* >();
-        _outBoundChannelDelays = map<interfaceId,int>();
-        _inBoundChannels = map<interfaceId,aChannel>();
+        _inStream = vector<Packet<message> >();
+        _inHead = 0;
+        _lastReceive = -1;
+        _outStream = vector<Packet<message> >();
+        _channels = vector<aChannel>();
+        _channelIndex = vector<std::pair<interfaceId, int> >();
+        _arrivals = vector<vector<Packet<message> > >(2);
+        _partition = 0;
+        _countBytes = false;
+        _bytesSent = 0;
+        _activityLog = nullptr;
+        _context = SimulationContext::current();
         _log = &cout;
         _printNeighborhood = false;
     }
 
     template <class message>
     NetworkInterface<message>::NetworkInterface(const NetworkInterface &rhs){
+        _arrivals = rhs._arrivals;
         _id = rhs._id;
-        _inStream = rhs._inStream;
+        _inStream = vector<Packet<message> >(rhs._inStream.begin() + rhs._inHead, rhs._inStream.end());
+        _inHead = 0;
+        _lastReceive = rhs._lastReceive;
         _outStream = rhs._outStream;
-        _outBoundChannels = rhs._outBoundChannels;
-        _inBoundChannels = rhs._inBoundChannels;
-        _outBoundChannelDelays = rhs._outBoundChannelDelays;
+        _channels = rhs._channels;
+        _channelIndex = rhs._channelIndex;
+        _neighbors = rhs._neighbors;
+        _neighborBits = rhs._neighborBits;
+        _pendingChannels = rhs._pendingChannels;
+        _partition = rhs._partition;
+        _countBytes = rhs._countBytes;
+        _bytesSent = rhs._bytesSent;
+        _activityLog = nullptr;
+        _context = rhs._context;
         _log = rhs._log;
         _printNeighborhood = rhs._printNeighborhood;
     }
 
     template <class message>
-    void NetworkInterface<message>::addChannel(NetworkInterface<message> &newNeighbor, int delay){
+    int NetworkInterface<message>::channelIndex(interfaceId id)const{
+        auto it = std::lower_bound(_channelIndex.begin(), _channelIndex.end(), std::make_pair(id, -1));
+        if (it == _channelIndex.end() || it->first != id) {
+            return -1;
+        }
+        return it->second;
+    }
+
+    template <class message>
+    void NetworkInterface<message>::addChannel(NetworkInterface<message> &newNeighbor, int delay, const LinkModel *link){
         // guard to make sure delay is at lest 1, less then 1 will couse errors when calculating delay (divisioin by 0)
         int edgeDelay = delay;
         if(edgeDelay < 1){
             edgeDelay = 1;
         }
-        _outBoundChannels[newNeighbor.id()] = &newNeighbor;
-        _outBoundChannelDelays[newNeighbor.id()] = edgeDelay;
-        _inBoundChannels[newNeighbor.id()] = deque<Packet<message> >();
+        int slot = channelIndex(newNeighbor.id());
+        if (slot == -1) {
+            slot = (int)_channels.size();
+            _channels.push_back(aChannel{newNeighbor.id(), &newNeighbor, edgeDelay, 0, link, 0, 0, 0, 0, 0});
+            // ids are usually added in increasing order
+            if (_channelIndex.empty() || _channelIndex.back().first < newNeighbor.id()) {
+                _channelIndex.push_back(std::make_pair(newNeighbor.id(), slot));
+            }
+            else {
+                _channelIndex.insert(std::lower_bound(_channelIndex.begin(), _channelIndex.end(), std::make_pair(newNeighbor.id(), -1)), std::make_pair(newNeighbor.id(), slot));
+            }
+        }
+        else {
+            _channels[slot].target = &newNeighbor;
+            _channels[slot].delay = edgeDelay;
+            _channels[slot].link = link;
+        }
+        newNeighbor.reserveArrivals(link == nullptr ? edgeDelay : link->maxDelay(edgeDelay));
+    }
+
+    template <class message>
+    void NetworkInterface<message>::removeChannel(const NetworkInterface<message> &neighbor){
+        int slot = channelIndex(neighbor.id());
+        if (slot == -1) {
+            return;
+        }
+        // move the last slot into the removed one and fix the index entry pointing to it
+        int last = (int)_channels.size() - 1;
+        if (slot != last) {
+            _channels[slot] = _channels[last];
+            for (auto it = _channelIndex.begin(); it != _channelIndex.end(); ++it) {
+                if (it->second == last) {
+                    it->second = slot;
+                }
+            }
+        }
+        _channels.pop_back();
+        _channelIndex.erase(std::lower_bound(_channelIndex.begin(), _channelIndex.end(), std::make_pair(neighbor.id(), -1)));
+    }
+
+    template <class message>
+    void NetworkInterface<message>::reserveArrivals(int delay){
+        // a packet arrives at most delay rounds after the round following the last receive
+        if (delay + 1 < _arrivals.size()) {
+            return;
+        }
+        vector<vector<Packet<message> > > wheel(delay + 2);
+        int next = _context->log().getRound() + 1;
+        for (auto &bucket : _arrivals) {
+            for (auto &packet : bucket) {
+                int arrival = std::max(packet.getRound() + packet.getDelay(), next);
+                wheel[arrival % wheel.size()].push_back(std::move(packet));
+            }
+        }
+        _arrivals.swap(wheel);
     }
 
     // called on recever
     template <class message>
-    void NetworkInterface<message>::send(Packet<message> outMessage){
-        _inBoundChannels.at(outMessage.sourceId()).push_back(outMessage);
+    void NetworkInterface<message>::deliver(Packet<message> &&outMessage){
+        // the sender made sure the packet arrives no earlier than the round it is delivered in
+        int arrival = std::max(outMessage.getRound() + outMessage.getDelay(), _context->log().getRound());
+        _arrivals[arrival % _arrivals.size()].push_back(std::move(outMessage));
     }
 
     // called on sender
     template <class message>
-    void NetworkInterface<message>::transmit(){
+    long NetworkInterface<message>::transmit(Outbox<message> &outbox){
+        long sent = 0;
         // send all messages to there destination peer channels  
-        while(!_outStream.empty()){
-			Packet<message> outMessage = _outStream.front();
-			_outStream.pop_front();
+        for(size_t i = 0; i < _outStream.size(); ++i){
+			Packet<message> &outMessage = _outStream[i];
 			if (_id == outMessage.targetId()) {// if sent to self loop back next round
 				outMessage.setDelay(1);
-				_inStream.push_back(outMessage);
+				_inStream.push_back(std::move(outMessage));
 			}
 			else if (!isNeighbor(outMessage.targetId()))// skip messages if they are not sent to a neighbor
 			{
 				continue;
 			}
 			else {
-				interfaceId targetId = outMessage.targetId();
-				int maxDelay = _outBoundChannelDelays.at(targetId);
-				outMessage.setDelay(maxDelay);
-				_outBoundChannels[targetId]->send(outMessage);
+				int slot = channelIndex(outMessage.targetId());
+				if (slot == -1) {// skip messages to neighbors without a channel
+					continue;
+				}
+				aChannel &channel = _channels[slot];
+				long bytes = 0;
+				if (_countBytes || (channel.link != nullptr && channel.link->bytesPerRound > 0)) {
+					bytes = (long)messageSize(outMessage.getMessage());
+				}
+				if (_countBytes) {
+					channel.bytes += bytes;
+					sent += bytes;
+				}
+				if (channel.link != nullptr) {
+					transmitOver(channel, std::move(outMessage), bytes, outbox);
+					continue;
+				}
+				outMessage.setDelay(channel.delay);
+				// packets that are already due are received on the next round
+				outMessage.holdUntil(_context->log().getRound() + 1);
+				// keep the channel in order, a packet can not arrive before the one sent ahead of it
+				outMessage.holdUntil(channel.lastArrival);
+				channel.lastArrival = outMessage.getRound() + outMessage.getDelay();
+				outbox[channel.target->partition()].push_back(Delivery<message>{channel.target, std::move(outMessage)});
 			}
 		}
+        _outStream.clear();
+        _bytesSent += sent;
+        return sent;
+    }
+
+    template <class message>
+    void NetworkInterface<message>::transmitOver(aChannel &channel, Packet<message> &&packet, long bytes, Outbox<message> &outbox){
+        const LinkModel &link = *channel.link;
+        if (LinkModel::chance(link.drop)) {
+            return;
+        }
+        const int round = _context->log().getRound();
+        // round the packet leaves in, packets beyond the bandwidth of the link wait for the next rounds
+        int departure = round;
+        if (link.packetsPerRound > 0) {
+            if (channel.queueRound < round) {
+                channel.queueRound = round;
+                channel.queued = 0;
+            }
+            if (channel.queued == link.packetsPerRound) {
+                ++channel.queueRound;
+                channel.queued = 0;
+            }
+            ++channel.queued;
+            departure = channel.queueRound;
+        }
+        if (link.bytesPerRound > 0) {
+            if (channel.byteRound < round) {
+                channel.byteRound = round;
+                channel.queuedBytes = 0;
+            }
+            // a packet that does not fit in what is left of a round is sent over the following ones
+            channel.queuedBytes += bytes;
+            while (channel.queuedBytes > link.bytesPerRound) {
+                ++channel.byteRound;
+                channel.queuedBytes -= link.bytesPerRound;
+            }
+            departure = std::max(departure, channel.byteRound);
+        }
+        int copies = LinkModel::chance(link.duplicate) ? 2 : 1;
+        for (int i = 0; i < copies; ++i) {
+            // the copy shares the body of the packet
+            Packet<message> outMessage = i + 1 < copies ? Packet<message>(packet) : std::move(packet);
+            int delay = link.hasDelay ? link.delay.getDelay() : uniformInt(1, channel.delay);
+            if (link.jitter > 0) {
+                delay += uniformInt(0, link.jitter);
+            }
+            outMessage.holdUntil(departure + delay);
+            outMessage.holdUntil(round + 1);
+            // a reordered packet may overtake the ones sent ahead of it
+            if (!LinkModel::chance(link.reorder)) {
+                outMessage.holdUntil(channel.lastArrival);
+            }
+            channel.lastArrival = std::max(channel.lastArrival, outMessage.getRound() + outMessage.getDelay());
+            outbox[channel.target->partition()].push_back(Delivery<message>{channel.target, std::move(outMessage)});
+        }
     }
 
     template <class message>
     void NetworkInterface<message>::receive() {
-        for (int i = 0; i != _inBoundChannels.size(); ++i) {
-            while(!_inBoundChannels[i].empty() && _inBoundChannels[i].front().hasArrived()){
-                _inStream.push_back(_inBoundChannels[i].front());
-                _inBoundChannels[i].pop_front();
+        const int round = _context->log().getRound();
+        // an interface that was not received for some rounds (see Network's active set) also takes the packets
+        // that arrived in those rounds, the buckets of one lap of the wheel hold all of them
+        const int from = std::max(_lastReceive + 1, round - (int)_arrivals.size() + 1);
+        _lastReceive = round;
+        bool arriving = false;
+        for (int r = from; r <= round && !arriving; ++r) {
+            arriving = !_arrivals[r % _arrivals.size()].empty();
+        }
+        if (!arriving) {
+            return;
+        }
+        // drop the messages that have already been read
+        if (_inHead != 0) {
+            _inStream.erase(_inStream.begin(), _inStream.begin() + _inHead);
+            _inHead = 0;
+        }
+        const size_t first = _inStream.size();
+        for (int r = from; r <= round; ++r) {
+            takeArrived(_arrivals[r % _arrivals.size()], round);
+        }
+
+        // packets from the same source keep the order they where sent in
+        auto bySource = [](const Packet<message> &a, const Packet<message> &b) {return a.sourceId() < b.sourceId();};
+        if (!std::is_sorted(_inStream.begin() + first, _inStream.end(), bySource)) {
+            std::stable_sort(_inStream.begin() + first, _inStream.end(), bySource);
+        }
+    }
+
+    template <class message>
+    void NetworkInterface<message>::takeArrived(vector<Packet<message> > &bucket, int round) {
+        // take the arrived packets, keep the ones due on a later lap of the wheel in order
+        size_t arrived = 0;
+        while (arrived < bucket.size() && bucket[arrived].hasArrived(round)) {
+            ++arrived;
+        }
+        // the packets ahead of the first one kept are moved in one go, a plain copy for packed messages
+        _inStream.insert(_inStream.end(), std::make_move_iterator(bucket.begin()), std::make_move_iterator(bucket.begin() + arrived));
+        size_t kept = 0;
+        for (size_t i = arrived; i < bucket.size(); ++i) {
+            if (bucket[i].hasArrived(round)) {
+                _inStream.push_back(std::move(bucket[i]));
+            }
+            else {
+                if (kept != i) {
+                    bucket[kept] = std::move(bucket[i]);
+                }
+                ++kept;
+            }
+        }
+        bucket.erase(bucket.begin() + kept, bucket.end());
+    }
+
+    template <class message>
+    int NetworkInterface<message>::nextArrival()const{
+        int next = std::numeric_limits<int>::max();
+        for (const auto &bucket : _arrivals) {
+            for (const auto &packet : bucket) {
+                next = std::min(next, packet.getRound() + packet.getDelay());
             }
         }
+        return next;
     }
 
 
     template <class message>
     bool NetworkInterface<message>::isNeighbor(interfaceId id)const{
-        if(find(_neighbors.begin(), _neighbors.end(), id) != _neighbors.end()){
-            return true;
-        }
-        return false;
+        size_t word = (size_t)id >> 6;
+        return id >= 0 && word < _neighborBits.size() && ((_neighborBits[word] >> (id & 63)) & 1);
     }
 
     template <class message>
     vector<interfaceId> NetworkInterface<message>::channels()const{
         vector<interfaceId> channelsToPeersByIds = vector<interfaceId>();
-        for (auto it=_outBoundChannels.begin(); it!=_outBoundChannels.end(); ++it){
+        for (auto it=_channelIndex.begin(); it!=_channelIndex.end(); ++it){
             channelsToPeersByIds.push_back(it->first);
         }
         return channelsToPeersByIds;
     }
 
+    template <class message>
+    long NetworkInterface<message>::bytesSentTo(interfaceId id)const{
+        int slot = channelIndex(id);
+        return slot == -1 ? 0 : _channels[slot].bytes;
+    }
+
     template <class message>
     int NetworkInterface<message>::getDelayToNeighbor(interfaceId id)const{
-        return _outBoundChannelDelays.at(id);
+        int slot = channelIndex(id);
+        if (slot == -1) {
+            throw std::out_of_range("no channel to interface " + std::to_string(id));
+        }
+        return _channels[slot].delay;
     }
 
     template <class message>
     void NetworkInterface<message>::clearMessages(){
         _inStream.clear();
+        _inHead = 0;
         _outStream.clear();
 
-        for(auto c : _inBoundChannels){
-            c.second.clear();
+        for(auto &bucket : _arrivals){
+            bucket.clear();
         }
     }
 
     template <class message>
     Packet<message> NetworkInterface<message>::popInStream(){
-        Packet<message> msg = _inStream.front();
-        _inStream.pop_front();
+        Packet<message> msg = std::move(_inStream[_inHead]);
+        ++_inHead;
+        if (_inHead == _inStream.size()) {
+            _inStream.clear();
+            _inHead = 0;
+        }
         return msg;
     }
 
+    template <class message>
+    void NetworkInterface<message>::noteActivity(){
+        if (_activityLog == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(_activityLog->lock);
+        _activityLog->ids.push_back(_id);
+        _activityLog = nullptr;
+    }
+
+    template <class message>
+    void NetworkInterface<message>::recycle(NetworkInterface<message> &old){
+        auto reuse = [](auto &mine, auto &theirs) {
+            if (mine.empty()) {
+                mine.swap(theirs);
+                mine.clear();
+            }
+        };
+        reuse(_channels, old._channels);
+        reuse(_channelIndex, old._channelIndex);
+        reuse(_inStream, old._inStream);
+        _inHead = 0;
+        reuse(_outStream, old._outStream);
+        reuse(_neighbors, old._neighbors);
+        reuse(_neighborBits, old._neighborBits);
+        reuse(_pendingChannels, old._pendingChannels);
+        // a larger wheel only means packets wait fewer laps, so the old one is kept if it is empty
+        bool unused = true;
+        for (auto &bucket : _arrivals) {
+            unused = unused && bucket.empty();
+        }
+        if (unused && old._arrivals.size() > _arrivals.size()) {
+            _arrivals.swap(old._arrivals);
+            for (auto &bucket : _arrivals) {
+                bucket.clear();
+            }
+        }
+    }
+
+    template <class message>
+    void NetworkInterface<message>::addNeighbor(interfaceId neighborIdAdd){
+        if (neighborIdAdd < 0 || isNeighbor(neighborIdAdd)) {
+            return;
+        }
+        size_t word = (size_t)neighborIdAdd >> 6;
+        if (word >= _neighborBits.size()) {
+            _neighborBits.resize(word + 1, 0);
+        }
+        _neighborBits[word] |= uint64_t(1) << (neighborIdAdd & 63);
+        _neighbors.push_back(neighborIdAdd);
+        if (neighborIdAdd != _id && !hasChannel(neighborIdAdd)) {
+            _pendingChannels.push_back(neighborIdAdd);
+        }
+    }
+
     template <class message>
     void NetworkInterface<message>::removeNeighbor(interfaceId neighborIdToRemove){
+        if (!isNeighbor(neighborIdToRemove)) {
+            return;
+        }
+        _neighborBits[(size_t)neighborIdToRemove >> 6] &= ~(uint64_t(1) << (neighborIdToRemove & 63));
         _neighbors.erase(std::remove(_neighbors.begin(), _neighbors.end(), neighborIdToRemove), _neighbors.end());
     }
 
@@ -386,11 +794,21 @@ namespace quantas{
         if(this == &rhs)
             return *this;
         _id = rhs._id;
-        _inStream = rhs._inStream;
+        _arrivals = rhs._arrivals;
+        _inStream = vector<Packet<message> >(rhs._inStream.begin() + rhs._inHead, rhs._inStream.end());
+        _inHead = 0;
+        _lastReceive = rhs._lastReceive;
         _outStream = rhs._outStream;
-        _outBoundChannels = rhs._outBoundChannels;
-        _inBoundChannels = rhs._inBoundChannels;
-        _outBoundChannelDelays = rhs._outBoundChannelDelays;
+        _channels = rhs._channels;
+        _channelIndex = rhs._channelIndex;
+        _neighbors = rhs._neighbors;
+        _neighborBits = rhs._neighborBits;
+        _pendingChannels = rhs._pendingChannels;
+        _partition = rhs._partition;
+        _countBytes = rhs._countBytes;
+        _bytesSent = rhs._bytesSent;
+        _activityLog = nullptr;
+        _context = rhs._context;
         _log = rhs._log;
         _printNeighborhood = rhs._printNeighborhood;
 
@@ -407,12 +825,16 @@ namespace quantas{
         out<< "-- NetworkInterface ID:"<< _id<< " --"<< endl;
         out<< left;
         out<< "\t"<< setw(LOG_WIDTH)<< "In Stream Size"<< setw(LOG_WIDTH)<< "Out Stream Size"<<endl;
-        out<< "\t"<< setw(LOG_WIDTH)<< _inStream.size()<< setw(LOG_WIDTH)<< _outStream.size()<<endl<<endl;
+        out<< "\t"<< setw(LOG_WIDTH)<< inStreamSize()<< setw(LOG_WIDTH)<< _outStream.size()<<endl<<endl;
         if(_printNeighborhood){
             out<< "\t"<< setw(LOG_WIDTH)<< "Neighbor ID"<< setw(LOG_WIDTH)<< "Delay"<< setw(LOG_WIDTH)<< "Messages In NetworkInterface"<< endl;
-            for (auto it=_outBoundChannels.begin(); it!=_outBoundChannels.end(); ++it){
-                interfaceId neighborId = it->first;
-                out<< "\t"<< setw(LOG_WIDTH)<< neighborId<< setw(LOG_WIDTH)<< getDelayToNeighbor(neighborId)<< setw(LOG_WIDTH)<<  _inBoundChannels.at(neighborId).size()<< endl;
+            for (auto it=_channelIndex.begin(); it!=_channelIndex.end(); ++it){
+                const aChannel &channel = _channels[it->second];
+                size_t inFlight = 0;
+                for (auto &bucket : _arrivals) {
+                    inFlight += std::count_if(bucket.begin(), bucket.end(), [&](const Packet<message> &p) {return p.sourceId() == channel.id;});
+                }
+                out<< "\t"<< setw(LOG_WIDTH)<< channel.id<< setw(LOG_WIDTH)<< channel.delay<< setw(LOG_WIDTH)<<  inFlight<< endl;
             }
         }
         out << endl;
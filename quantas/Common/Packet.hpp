@@ -15,6 +15,19 @@ You should have received a copy of the GNU General Public License along with QUA
 // The Id of the packet is used for comparison of two packets. Structs can not be compared unless the user defines the equal to and not
 // equal operator. As such we do not expect or assume that the user does so. We define a packet ID to overcome this two packets with the
 // same id are regarded as equal.
+//
+// The body of a packet is reference counted and never modified while it is shared. Copying a packet, or
+// sending the same message to many peers (broadcast), shares one body instead of copying the message. A
+// packet without a body holds a default constructed message. getMessage gives read access to the body,
+// takeMessage moves it out of the packet when no other packet shares it.
+//
+// Small trivially copyable messages (plain structs of numbers and enums, see isPackedMessage) are packed
+// into the packet instead. Copying such a packet copies the message, which is cheaper than sharing a
+// reference counted body, and the packet is trivially copyable itself so the arrays of packets held by
+// the network interfaces are moved with memcpy. The choice is made at compile time by PacketBody.
+//
+// A packet is stamped with the round of the simulation context the thread creating it works for. Bodies are allocated from a slab
+// pool (see PacketPool.hpp) so creating a message does not call malloc once the simulation is warmed up.
 
 
 #ifndef Packet_hpp
@@ -24,7 +37,10 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <string>
 #include <ctime>
 #include <random>
+#include <memory>
+#include <type_traits>
 #include "LogWriter.hpp"
+#include "PacketPool.hpp"
 #include "Distribution.hpp"
 
 namespace quantas{
@@ -32,6 +48,57 @@ namespace quantas{
     using std::string;
     
     static const long NO_PEER_ID = -1;  // number used to indicate invalid peer id or un init peer id
+    static const size_t PACKED_MESSAGE_SIZE = 64; // largest message packed into its packets
+
+    // whether a message is packed into its packets instead of being shared between them
+    template<class message>
+    struct isPackedMessage : std::integral_constant<bool, std::is_trivially_copyable<message>::value && sizeof(message) <= PACKED_MESSAGE_SIZE> {};
+
+    // body of a packet, reference counted and allocated from the packet pool
+    template<class message, bool packed = isPackedMessage<message>::value>
+    class PacketBody{
+    private:
+        std::shared_ptr<message>    _body; // nullptr for a default message
+
+    public:
+        // a body that can be given to many packets
+        typedef std::shared_ptr<message> Shared;
+
+        template<class... Args>
+        static Shared   make        (Args&&... args){return std::allocate_shared<message>(PoolAllocator<message>(), std::forward<Args>(args)...);};
+        void            set         (Shared body){_body = std::move(body);};
+        const message&  get         ()const {static const message empty = message(); return _body ? *_body : empty;};
+        message         take        ();
+    };
+
+    template<class message, bool packed>
+    message PacketBody<message, packed>::take(){
+        if (!_body) {
+            return message();
+        }
+        std::shared_ptr<message> body = std::move(_body);
+        if (body.use_count() == 1) {
+            return std::move(*body);
+        }
+        return *body;
+    }
+
+    // body of a packet holding the message itself
+    template<class message>
+    class PacketBody<message, true>{
+    private:
+        message                     _body = message();
+
+    public:
+        // packets are given a copy of the message
+        typedef message Shared;
+
+        template<class... Args>
+        static Shared   make        (Args&&... args){return message(std::forward<Args>(args)...);};
+        void            set         (const Shared &body){_body = body;};
+        const message&  get         ()const {return _body;};
+        message         take        (){message body = _body; _body = message(); return body;};
+    };
 
     //
     //Base Message Class
@@ -48,38 +115,57 @@ namespace quantas{
         long                        _targetId; // target node id
         long                        _sourceId; // source node id
         
-        message                     _body;
+        PacketBody<message>         _body; // the message, shared between copies of the packet unless it is packed
         
         int                         _delay; // delay of the message
         int                         _round; // round message was sent
         
     public:
+        // body made by makeBody that can be given to many packets
+        typedef typename PacketBody<message>::Shared SharedBody;
+
         Packet                      (long id);
         Packet                      (long id, long to, long from);
-        Packet                      (const Packet<message>&);
-        ~Packet                     ();
+        // copies share the body of the packet, or copy it when it is packed
+        Packet                      (const Packet<message>&) = default;
+        Packet                      (Packet<message>&&) = default;
+        ~Packet                     () = default;
         
         // setters
         void        setSource       (long s){_sourceId = s;};
         void        setTarget       (long t){_targetId = t;};
         void        setDelay        (int delayMax, int delayMin = 1);
-        void        setMessage      (const message c){_body = c;};
+        // extends the delay so the packet does not arrive before the given round
+        void        holdUntil       (int round){if (_round + _delay < round) _delay = round - _round;};
+        void        setMessage      (const message &c){_body.set(makeBody(c));};
+        void        setMessage      (message &&c){_body.set(makeBody(std::move(c)));};
+        // share a body with other packets, it must not be modified afterwards
+        void        setBody         (const SharedBody &body){_body.set(body);};
         
         // getters
         long        id              ()const {return _id;};
         long        targetId        ()const {return _targetId;};
         long        sourceId        ()const {return _sourceId;};
-        bool        hasArrived      ()const {return LogWriter::instance()->getRound() >= _round + _delay;};
-        message     getMessage      ()const {return _body;};
+        bool        hasArrived      ()const {return hasArrived(LogWriter::instance()->getRound());};
+        // whether the packet has arrived by the given round
+        bool        hasArrived      (int round)const {return round >= _round + _delay;};
+        const message& getMessage   ()const {return _body.get();};
+        // moves the body out of the packet (copies it if other packets share it), the packet is left with a default message
+        message     takeMessage     (){return _body.take();};
         int         getDelay        ()const {return _delay;};
         int         getRound        ()const {return _round;};
         
+        // allocates a body from the packet pool, or makes a copy of the message when it is packed
+        template<class... Args>
+        static SharedBody makeBody  (Args&&... args){return PacketBody<message>::make(std::forward<Args>(args)...);};
+        
         // mutators
         //void        moveForward     (){_delay = _delay > 0 ? _delay-1 : 0;};
         
         //void
         
-        Packet&     operator=       (const Packet<message> &rhs);
+        Packet&     operator=       (const Packet<message> &rhs) = default;
+        Packet&     operator=       (Packet<message> &&rhs) = default;
         bool        operator==      (const Packet<message> &rhs) const;
         bool        operator!=      (const Packet<message> &rhs) const;
         
@@ -90,7 +176,6 @@ namespace quantas{
         _id = id;
         _sourceId = NO_PEER_ID;
         _targetId = NO_PEER_ID;
-        _body = message();
         _delay = 0;
         _round = LogWriter::instance()->getRound();
     }
@@ -100,26 +185,10 @@ namespace quantas{
         _id = id;
         _sourceId = from;
         _targetId = to;
-        _body = message();
         _delay = 0;
         _round = LogWriter::instance()->getRound();
     }
 
-    template<class message>
-    Packet<message>::Packet(const Packet<message>& rhs){
-        _id = rhs._id;
-        _targetId = rhs._targetId;
-        _sourceId = rhs._sourceId;
-        _body = rhs._body;
-        _delay = rhs._delay;
-        _round = rhs._round;
-    }
-
-    template<class message>
-    Packet<message>::~Packet(){
-        // no memory allocated so nothing to do
-    }
-
     template <class message>
     void Packet<message>::setDelay(int maxDelay, int minDelay){
         // max is not included so delay 1 is next round delay 2 is one round
@@ -127,17 +196,6 @@ namespace quantas{
         _delay = uniformInt(minDelay, maxDelay);
     }
 
-    template<class message>
-    Packet<message>& Packet<message>::operator=(const Packet<message> &rhs){
-        _id = rhs._id;
-        _targetId = rhs._targetId;
-        _sourceId = rhs._sourceId;
-        _body = rhs._body;
-        _delay = rhs._delay;
-        _round = rhs._round;
-        return *this;
-    }
-
     template<class message>
     bool Packet<message>::operator== (const Packet<message> &rhs)const{
         return _id == rhs._id;
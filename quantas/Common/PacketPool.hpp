@@ -0,0 +1,218 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Slab pool used for the bodies of packets. A body is allocated once per message and released once every packet
+// sharing it has been delivered, which made it the one allocation left in each round. The pool carves fixed size
+// blocks out of large slabs and keeps released blocks on a free list, so after the first few rounds of a simulation
+// messages are created and destroyed without calling malloc.
+//
+// Each thread keeps its own free list and slab so that peers computing in parallel do not contend. A block released
+// on a different thread from the one that allocated it simply joins the releasing thread's list. Slabs are owned by
+// the pool of their block size and are only freed when the program exits, since blocks move between threads. Blocks
+// beyond two slabs' worth on a free list, and when a thread exits its free list and the unused rest of its slab, go
+// to a depot shared by the threads of the pool, which a thread takes from before it carves a new slab. A thread that
+// mostly sends thus reuses the blocks released by the threads that receive, and the threads started for every test
+// reuse the same memory.
+//
+// PoolAllocator is a standard allocator over these pools, Packet uses it with std::allocate_shared so the reference
+// count and the message share one block.
+
+#ifndef PacketPool_hpp
+#define PacketPool_hpp
+
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+namespace quantas{
+
+    template<size_t blockSize, size_t blockAlign>
+    class SlabPool{
+    private:
+        // a released block, linked through its own storage
+        struct FreeBlock {
+            FreeBlock*                  next;
+        };
+
+        static constexpr size_t         BLOCK = (blockSize + blockAlign - 1) / blockAlign * blockAlign < sizeof(FreeBlock) ?
+                                                sizeof(FreeBlock) : (blockSize + blockAlign - 1) / blockAlign * blockAlign;
+        static constexpr size_t         ALIGN = blockAlign < alignof(FreeBlock) ? alignof(FreeBlock) : blockAlign;
+        static constexpr size_t         SLAB_BLOCKS = BLOCK > 4096 ? 16 : 65536 / BLOCK;
+
+        // every slab handed out by this pool, freed at exit, and the blocks left by threads that exited
+        struct Slabs {
+            std::mutex                  lock;
+            std::vector<void*>          slabs;
+            FreeBlock*                  free = nullptr;     // blocks released by threads that exited
+            std::vector<std::pair<char*, char*> > rests;    // unused [next, end) of the slabs of threads that exited
+            ~Slabs                      (){for (void* slab : slabs) ::operator delete(slab, std::align_val_t(ALIGN));};
+        };
+
+        static Slabs&                   slabs               (){static Slabs s; return s;};
+
+        // the blocks of one thread, handed to the depot when the thread exits
+        struct Cache {
+            FreeBlock*                  free = nullptr;     // blocks released on this thread
+            size_t                      count = 0;          // number of blocks on free
+            char*                       next = nullptr;     // next unused block of this thread's slab
+            char*                       end = nullptr;      // end of this thread's slab
+            ~Cache                      ();
+        };
+
+        static thread_local Cache       _cache;
+
+        // refills the cache from the depot, or with a new slab when the depot is empty
+        static void                     refill              ();
+        // moves the blocks after the first SLAB_BLOCKS of the cache's free list to the depot
+        static void                     spill               ();
+
+    public:
+        static void*                    allocate            ();
+        static void                     release             (void* block);
+    };
+
+    template<size_t blockSize, size_t blockAlign>
+    thread_local typename SlabPool<blockSize, blockAlign>::Cache SlabPool<blockSize, blockAlign>::_cache;
+
+    template<size_t blockSize, size_t blockAlign>
+    SlabPool<blockSize, blockAlign>::Cache::~Cache(){
+        Slabs& owner = slabs();
+        std::lock_guard<std::mutex> guard(owner.lock);
+        if (free != nullptr) {
+            FreeBlock* last = free;
+            while (last->next != nullptr) {
+                last = last->next;
+            }
+            last->next = owner.free;
+            owner.free = free;
+        }
+        if (next != end) {
+            owner.rests.push_back(std::make_pair(next, end));
+        }
+        free = nullptr;
+        count = 0;
+        next = end = nullptr;
+    }
+
+    template<size_t blockSize, size_t blockAlign>
+    void SlabPool<blockSize, blockAlign>::refill(){
+        Slabs& owner = slabs();
+        std::lock_guard<std::mutex> guard(owner.lock);
+        if (owner.free != nullptr) {
+            // take a slab's worth of blocks, threads refilling at the same time share the depot
+            FreeBlock* last = owner.free;
+            size_t taken = 1;
+            for (; taken < SLAB_BLOCKS && last->next != nullptr; ++taken) {
+                last = last->next;
+            }
+            _cache.free = owner.free;
+            _cache.count = taken;
+            owner.free = last->next;
+            last->next = nullptr;
+            return;
+        }
+        if (!owner.rests.empty()) {
+            _cache.next = owner.rests.back().first;
+            _cache.end = owner.rests.back().second;
+            owner.rests.pop_back();
+            return;
+        }
+        void* slab = ::operator new(BLOCK * SLAB_BLOCKS, std::align_val_t(ALIGN));
+        owner.slabs.push_back(slab);
+        _cache.next = static_cast<char*>(slab);
+        _cache.end = _cache.next + BLOCK * SLAB_BLOCKS;
+    }
+
+    template<size_t blockSize, size_t blockAlign>
+    void SlabPool<blockSize, blockAlign>::spill(){
+        FreeBlock* kept = _cache.free;
+        for (size_t i = 1; i < SLAB_BLOCKS; ++i) {
+            kept = kept->next;
+        }
+        FreeBlock* first = kept->next;
+        FreeBlock* last = first;
+        while (last->next != nullptr) {
+            last = last->next;
+        }
+        kept->next = nullptr;
+        _cache.count = SLAB_BLOCKS;
+
+        Slabs& owner = slabs();
+        std::lock_guard<std::mutex> guard(owner.lock);
+        last->next = owner.free;
+        owner.free = first;
+    }
+
+    template<size_t blockSize, size_t blockAlign>
+    void* SlabPool<blockSize, blockAlign>::allocate(){
+        Cache& cache = _cache;
+        if (cache.free == nullptr && cache.next == cache.end) {
+            refill();
+        }
+        if (cache.free != nullptr) {
+            FreeBlock* block = cache.free;
+            cache.free = block->next;
+            --cache.count;
+            return block;
+        }
+        void* block = cache.next;
+        cache.next += BLOCK;
+        return block;
+    }
+
+    template<size_t blockSize, size_t blockAlign>
+    void SlabPool<blockSize, blockAlign>::release(void* block){
+        Cache& cache = _cache;
+        FreeBlock* freed = static_cast<FreeBlock*>(block);
+        freed->next = cache.free;
+        cache.free = freed;
+        if (++cache.count > 2 * SLAB_BLOCKS) {
+            spill();
+        }
+    }
+
+    template<class T>
+    class PoolAllocator{
+    public:
+        typedef T                       value_type;
+
+        PoolAllocator                   () noexcept {};
+        template<class U>
+        PoolAllocator                   (const PoolAllocator<U>&) noexcept {};
+
+        T*                              allocate            (size_t n);
+        void                            deallocate          (T* p, size_t n);
+
+        template<class U>
+        bool                            operator==          (const PoolAllocator<U>&) const noexcept {return true;};
+        template<class U>
+        bool                            operator!=          (const PoolAllocator<U>&) const noexcept {return false;};
+    };
+
+    template<class T>
+    T* PoolAllocator<T>::allocate(size_t n){
+        if (n != 1) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        return static_cast<T*>(SlabPool<sizeof(T), alignof(T)>::allocate());
+    }
+
+    template<class T>
+    void PoolAllocator<T>::deallocate(T* p, size_t n){
+        if (n != 1) {
+            ::operator delete(p, std::align_val_t(alignof(T)));
+            return;
+        }
+        SlabPool<sizeof(T), alignof(T)>::release(p);
+    }
+}
+
+#endif /* PacketPool_hpp */
@@ -27,6 +27,7 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include "NetworkInterface.hpp"
 #include "LogWriter.hpp"
 
@@ -56,42 +57,43 @@ namespace quantas{
         virtual void                       performComputation      () = 0;
         // ran once per round, used to submit transactions or collect metrics
         virtual void                       endOfRound              (const vector<Peer<message>*>& _peers) {};
-        static int                         getRound                ()                                     { return _round; };
-        static int                         getLastRound            ()                                     { return _lastRound; };
-        static void                        initializeRound         ()                                     { _round = 0; };
-        static void                        incrementRound          ()                                     { _round++; };
-        static void                        initializeLastRound     (int lastRound)                        { _lastRound = lastRound; };
-        static bool                        lastRound               ()                                     { return _lastRound == _round; };
-        static void                        initializeSourcePoolSize(int sourcePoolSize)                   { _sourcePoolSize = sourcePoolSize; };
-        static int                         getSourcePoolSize       ()                                     { return _sourcePoolSize; };
+        // the current round, last round and size of source pool (FOR BLOCKCHAIN IN DYNAMIC NETWORKS) are
+        // kept by the simulation context the peer is part of
+        int                                getRound                ()const                                { return this->context()->round(); };
+        int                                getLastRound            ()const                                { return this->context()->lastRound(); };
+        bool                               lastRound               ()const                                { return getLastRound() == getRound(); };
+        int                                getSourcePoolSize       ()const                                { return this->context()->sourcePoolSize(); };
+        // state of type T shared by all the peers of the simulation
+        template<class T>
+        T&                                 sharedState             ()const                                { return this->context()->template state<T>(); };
+
+        // with the active set scheduler (see Network) a peer that has nothing to do can be skipped. After
+        // idleUntil the peer is not received, computed or transmitted from the next round on, until a packet
+        // arrives for it, the given round is reached or wake is called
+        static constexpr int               NEVER = std::numeric_limits<int>::max();
+        void                               idleUntil               (int round = NEVER)                    { _idleUntil = round; this->noteActivity(); };
+        void                               wake                    ()                                     { _idleUntil = -1; this->noteActivity(); };
+        // whether the peer asked to be skipped after the current round
+        bool                               idle                    ()const                                { return _idleUntil > getRound(); };
+        int                                idleRound               ()const                                { return _idleUntil; };
+
     private:
-        // current round
-        static int                         _round;
-        // last round
-        static int                        _lastRound;
-        // size of source pool (FOR BLOCKCHAIN IN DYNAMIC NETWORKS)
-        static int                        _sourcePoolSize;
+        int                                _idleUntil;             // round the peer is idle until, -1 when it is not idle
     };
 
-    template <class message>
-    int Peer<message>::_round = 0;
-    
-    template <class message>
-    int Peer<message>::_lastRound = 0;
-    
-    template <class message>
-    int Peer<message>::_sourcePoolSize = 0;
-
     template <class message>
     Peer<message>::Peer(): NetworkInterface<message>(){
+        _idleUntil = -1;
     }
 
     template <class message>
     Peer<message>::Peer(long id): NetworkInterface<message>(id){
+        _idleUntil = -1;
     }
 
     template <class message>
     Peer<message>::Peer(const Peer &rhs){
+        _idleUntil = rhs._idleUntil;
     }
 
     template <class message>
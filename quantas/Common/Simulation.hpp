@@ -11,6 +11,27 @@ You should have received a copy of the GNU General Public License along with QUA
 // initializing the network class, and repeating a simulation according to the configuration file 
 // (i.e., running multiple experiments with the same configuration).  It is templated with a user 
 // defined message and peer class, used for the underlaying network instance. 
+//
+// Rounds are run with "threadCount" threads (all hardware cores by default). Setting "scheduler" to
+// "pinned" in the experiment replaces the thread pool with one worker per partition of the network.
+// Each worker is pinned to a core, owns the same peers for the whole test and waits for the others on
+// a spinning barrier, the serial end of round is run by the last worker to reach it. Workers are pinned
+// from core "firstCore" on (0 by default), the experiment runner sets it for experiments running at
+// the same time so they use different cores (see main).
+// Setting "workStealing" to true lets threads that finished computing their own peers compute
+// the peers of busier threads (see Network), with either scheduler.
+// Setting "parallelTests" to a number above one runs that many tests at the same time, each on its
+// own network and simulation context (see SimulationContext) and an equal share of the threads.
+// Their results are merged into the same output.
+// Setting "seed" makes the random numbers of the experiment depend on nothing but the seed, so its
+// results are the same for any "threadCount" or scheduler (see SimulationContext). Without it each
+// run of the experiment draws a new seed, which is logged as "seed" so the run can be repeated.
+// Setting "countBytes" to true logs the bytes sent in each test (see Network).
+// Setting "activeSet" to true skips the peers that declared themselves idle (see Network and Peer).
+// Setting "eventDriven" to true also skips the rounds in which no peer is active and no packet arrives,
+// the clock moves straight to the next one in which something happens (see Network).
+// Setting "speed" gives the peers process speeds, a peer only steps in the rounds drawn from its speed
+// and the steps each peer took are logged (see Network).
 
 #ifndef Simulation_hpp
 #define Simulation_hpp
@@ -18,10 +39,19 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <chrono>
 #include <thread>
 #include <fstream>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <random>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "Network.hpp"
 #include "LogWriter.hpp"
 #include "BS_thread_pool.hpp"
+#include "SpinBarrier.hpp"
 
 
 using std::ofstream;
@@ -38,6 +68,15 @@ namespace quantas {
     private:
         Network<type_msg, peer_type> 		system;
         ostream                             *_log;
+
+        // sets up the network and runs one test on it
+        static void         runTest     (Network<type_msg, peer_type>&, BS::thread_pool&, json config, int test, int threads, bool pinned, int firstCore);
+        // runs the rounds of one test on the thread pool, the network picks the round run after each one
+        static void         runPooled   (Network<type_msg, peer_type>&, BS::thread_pool&, int rounds);
+        // runs the rounds of one test on one pinned worker per partition, pinned from the given core on
+        static void         runPinned   (Network<type_msg, peer_type>&, int rounds, int firstCore);
+        // binds the calling thread to a core, does nothing where this is not supported
+        static void         pinToCore   (int core);
     public:
         // Name of log file, will have Test number appended
         void 				run			(json);
@@ -56,8 +95,9 @@ namespace quantas {
 	template<class type_msg, class peer_type>
 	void Simulation<type_msg, peer_type>::run(json config) {
 		ofstream out;
+		ostream *previousLog = LogWriter::instance()->getLog();
 		if (config["logFile"] == "cout") {
-			LogWriter::instance()->setLog(cout); // Set the log file to the console
+			// keep the console of the writer, the experiment runner may have captured it
 		}
 		else {
 			string file = config["logFile"];
@@ -82,36 +122,69 @@ namespace quantas {
 		if (_threadCount > config["topology"]["totalPeers"]) {
 			_threadCount = config["topology"]["totalPeers"];
 		}
-		int networkSize = static_cast<int>(config["topology"]["totalPeers"]);
 		
-		BS::thread_pool pool(_threadCount);
-		for (int i = 0; i < config["tests"]; i++) {
-			LogWriter::instance()->setTest(i);
-
-			// Configure the delay properties and initial topology of the network
-			system.setDistribution(config["distribution"]);
-			system.initNetwork(config["topology"], config["rounds"]);
-			if (config.contains("parameters")) {
-				system.initParameters(config["parameters"]);
-			}
-			
-			//cout << "Test " << i + 1 << endl;
-			for (int j = 0; j < config["rounds"]; j++) {
-				//cout << "ROUND " << j << endl;
-				LogWriter::instance()->setRound(j); // Set the round number for logging
-
-				// do the receive phase of the round
-
-				BS::multi_future<void> receive_loop = pool.parallelize_loop(networkSize, [this](int a, int b){system.receive(a, b);});
-				receive_loop.wait();
-
-				BS::multi_future<void> compute_loop = pool.parallelize_loop(networkSize, [this](int a, int b){system.performComputation(a, b);});
-				compute_loop.wait();
-
-				system.endOfRound(); // do any end of round computations
+		bool pinned = config.contains("scheduler") && config["scheduler"] == "pinned";
+		int firstCore = config.contains("firstCore") ? config["firstCore"].get<int>() : 0;
+		bool workStealing = config.contains("workStealing") && config["workStealing"] == true;
+		bool countBytes = config.contains("countBytes") && config["countBytes"] == true;
+		bool eventDriven = config.contains("eventDriven") && config["eventDriven"] == true;
+		// skipping rounds and process speeds rely on the active set
+		bool activeSet = eventDriven || config.contains("speed") || (config.contains("activeSet") && config["activeSet"] == true);
+		int tests = config["tests"];
+		int parallelTests = 1;
+		if (config.contains("parallelTests") && config["parallelTests"] > 1) {
+			parallelTests = std::min(static_cast<int>(config["parallelTests"]), tests);
+		}
+		uint64_t seed = static_cast<uint64_t>(std::random_device()()) << 32 ^ static_cast<uint64_t>(time(nullptr));
+		if (config.contains("seed")) {
+			seed = config["seed"].get<uint64_t>();
+		}
+		LogWriter::instance()->data["seed"] = seed;
 
-				BS::multi_future<void> transmit_loop = pool.parallelize_loop(networkSize, [this](int a, int b){system.transmit(a, b);});
-				transmit_loop.wait();
+		if (parallelTests <= 1) {
+			// the pinned scheduler starts its own workers for each test
+			BS::thread_pool pool(pinned ? 1 : _threadCount);
+			system.setContext(SimulationContext::current());
+			system.context()->setSeed(seed);
+			system.setWorkStealing(workStealing);
+			system.setCountBytes(countBytes);
+			system.setActiveSet(activeSet);
+			system.setEventDriven(eventDriven);
+			for (int i = 0; i < tests; i++) {
+				//cout << "Test " << i + 1 << endl;
+				runTest(system, pool, config, i, _threadCount, pinned, firstCore);
+			}
+		}
+		else {
+			// each runner takes the next test not yet started until all are done
+			int threads = std::max(1, _threadCount / parallelTests);
+			vector<std::unique_ptr<SimulationContext> > contexts(tests);
+			for (int i = 0; i < tests; i++) {
+				contexts[i].reset(new SimulationContext());
+				contexts[i]->setSeed(seed);
+			}
+			std::atomic<int> nextTest(0);
+			vector<thread> runners;
+			for (int r = 0; r < parallelTests; r++) {
+				runners.push_back(thread([&, r]() {
+					BS::thread_pool pool(pinned ? 1 : threads);
+					Network<type_msg, peer_type> network;
+					network.setWorkStealing(workStealing);
+					network.setCountBytes(countBytes);
+					network.setActiveSet(activeSet);
+					network.setEventDriven(eventDriven);
+					for (int i = nextTest++; i < tests; i = nextTest++) {
+						SimulationContext::Scope scope(contexts[i].get());
+						network.setContext(contexts[i].get());
+						runTest(network, pool, config, i, threads, pinned, firstCore + r * threads);
+					}
+				}));
+			}
+			for (auto &runner : runners) {
+				runner.join();
+			}
+			for (int i = 0; i < tests; i++) {
+				LogWriter::instance()->merge(contexts[i]->log());
 			}
 		}
 		
@@ -120,9 +193,108 @@ namespace quantas {
 		LogWriter::instance()->data["RunTime"] = duration.count();
 
 		LogWriter::instance()->print();
+		LogWriter::instance()->setLog(*previousLog);
 		out.close();
 	}
 
+	template<class type_msg, class peer_type>
+	void Simulation<type_msg, peer_type>::runTest(Network<type_msg, peer_type> &system, BS::thread_pool &pool, json config, int test, int threads, bool pinned, int firstCore) {
+		system.context()->log().setTest(test);
+
+		// Configure the delay properties and initial topology of the network
+		system.setDistribution(config["distribution"]);
+		system.initNetwork(config["topology"], config["rounds"]);
+		system.setSpeeds(config.contains("speed") ? config["speed"] : json());
+		system.setPartitions(threads);
+		if (config.contains("parameters")) {
+			system.initParameters(config["parameters"]);
+		}
+
+		if (pinned) {
+			runPinned(system, config["rounds"], firstCore);
+		}
+		else {
+			runPooled(system, pool, config["rounds"]);
+		}
+		system.logBytes();
+		system.logSkippedRounds();
+		system.logSteps();
+	}
+
+	template<class type_msg, class peer_type>
+	void Simulation<type_msg, peer_type>::runPooled(Network<type_msg, peer_type> &system, BS::thread_pool &pool, int rounds) {
+		// the calling thread and the pool's threads work for the network's simulation
+		SimulationContext *context = system.context();
+		SimulationContext::Scope scope(context);
+		for (int j = 0; j < rounds; j = system.nextRound()) {
+			//cout << "ROUND " << j << endl;
+			context->log().setRound(j); // Set the round number for logging
+
+			// do the receive and compute phases of the round, a peer only reads the packets delivered to it
+			// so each partition can compute as soon as it has received
+			BS::multi_future<void> compute_loop = pool.parallelize_loop(system.partitions(), [&system, context](int a, int b){SimulationContext::Scope scope(context); for (int p = a; p < b; p++) system.receiveAndCompute(p);});
+			compute_loop.wait();
+
+			system.endOfRound(); // do any end of round computations
+
+			BS::multi_future<void> transmit_loop = pool.parallelize_loop(system.partitions(), [&system, context](int a, int b){SimulationContext::Scope scope(context); for (int p = a; p < b; p++) system.transmit(p);});
+			transmit_loop.wait();
+		}
+	}
+
+	template<class type_msg, class peer_type>
+	void Simulation<type_msg, peer_type>::runPinned(Network<type_msg, peer_type> &system, int rounds, int firstCore) {
+		SpinBarrier barrier(system.partitions());
+		SimulationContext *context = system.context();
+		int round = -1; // round the workers run next, picked by the last worker to finish the previous one
+		std::vector<thread> workers;
+		for (int p = 0; p < system.partitions(); p++) {
+			workers.push_back(thread([&system, &barrier, &round, context, p, rounds, firstCore]() {
+				SimulationContext::Scope scope(context);
+				pinToCore(firstCore + p);
+				while (true) {
+					// every worker has transmitted the previous round
+					barrier.wait([&system, &round, context, rounds]() {
+						round = round < 0 ? 0 : system.nextRound();
+						if (round < rounds) {
+							context->log().setRound(round);
+						}
+					});
+					if (round >= rounds) {
+						break;
+					}
+					system.receiveAndCompute(p);
+					barrier.wait([&system]() {system.endOfRound();});
+					system.transmit(p);
+				}
+			}));
+		}
+		for (auto &worker : workers) {
+			worker.join();
+		}
+	}
+
+	template<class type_msg, class peer_type>
+	void Simulation<type_msg, peer_type>::pinToCore(int core) {
+#if defined(__linux__)
+		// pick among the cores the process is allowed to run on
+		cpu_set_t allowed;
+		if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+			return;
+		}
+		int skip = core % CPU_COUNT(&allowed);
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &allowed) && skip-- == 0) {
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				CPU_SET(cpu, &set);
+				pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+				return;
+			}
+		}
+#endif
+	}
+
 	
 }
 
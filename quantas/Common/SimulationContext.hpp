@@ -0,0 +1,117 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// The state of one running simulation: its results (LogWriter), the round the peers are in and the
+// state an algorithm shares between all of its peers. Nothing about a simulation is kept in static
+// members, so any number of simulations can run in one process at the same time.
+//
+// Network and NetworkInterface hold a pointer to their context. Code that can not be handed one, such
+// as the LogWriter::instance() calls in the algorithms or the constructor of Packet, uses the context
+// the calling thread is working for. The simulation sets it with a Scope on every thread it runs
+// peers on, threads without one use a process wide context.
+//
+// Algorithms keep the values shared by their peers (transaction counters, parameters, ...) in a
+// struct of their own and get the instance belonging to the context with state<T>(). It is default
+// constructed the first time it is asked for and lives as long as the context.
+//
+// The context also holds the seed of the simulation. Before a thread computes a peer, transmits its
+// messages or runs a serial part of a round it selects the random stream of that step with useStream,
+// which makes a simulation with a seed ("seed" in the input) give the same results for any number of
+// threads. Without a seed every experiment draws a new one.
+
+#ifndef SimulationContext_hpp
+#define SimulationContext_hpp
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include "LogWriter.hpp"
+#include "Distribution.hpp"
+
+namespace quantas {
+
+    class SimulationContext {
+    private:
+        LogWriter                                           _log;
+        int                                                 _round = 0;            // rounds the peers have completed
+        int                                                 _lastRound = 0;
+        int                                                 _sourcePoolSize = 0;   // size of source pool (FOR BLOCKCHAIN IN DYNAMIC NETWORKS)
+        uint64_t                                            _seed = 0;             // seed of the random streams
+        std::mutex                                          _stateLock;            // guards _state while peers are created
+        std::map<std::type_index, std::shared_ptr<void> >   _state;                // algorithm state by type
+
+        inline static thread_local SimulationContext*       _current = nullptr;
+
+    public:
+        // the steps a random stream can be drawn for, a peer has a stream for computing, one for transmitting
+        // and one for drawing the round of its next step (see the speed model of Network)
+        enum Phase { SETUP, COMPUTE, END_OF_ROUND, TRANSMIT, SCHEDULE };
+
+        SimulationContext                                   () {};
+        SimulationContext                                   (const SimulationContext&) = delete;
+        SimulationContext&      operator=                   (const SimulationContext&) = delete;
+
+        // context the calling thread is working for
+        static SimulationContext* current                   ();
+
+        // makes a context the current one of the calling thread for the lifetime of the scope
+        class Scope {
+        private:
+            SimulationContext*  _previous;
+        public:
+            Scope   (SimulationContext* context) : _previous(_current) { _current = context; }
+            ~Scope  ()                                              { _current = _previous; }
+            Scope   (const Scope&) = delete;
+            Scope&  operator= (const Scope&) = delete;
+        };
+
+        LogWriter&              log                         ()                          { return _log; }
+        const LogWriter&        log                         ()const                     { return _log; }
+        int                     round                       ()const                     { return _round; }
+        void                    setRound                    (int round)                 { _round = round; }
+        int                     lastRound                   ()const                     { return _lastRound; }
+        void                    setLastRound                (int round)                 { _lastRound = round; }
+        int                     sourcePoolSize              ()const                     { return _sourcePoolSize; }
+        void                    setSourcePoolSize           (int size)                  { _sourcePoolSize = size; }
+        uint64_t                seed                        ()const                     { return _seed; }
+        void                    setSeed                     (uint64_t seed)             { _seed = seed; }
+
+        // makes the calling thread draw from the stream of a step of the current round, stream is the id of
+        // the peer for COMPUTE and TRANSMIT
+        void                    useStream                   (Phase phase, long stream = 0)const { RANDOM_GENERATOR.reset(_seed, _log.getTest(), _round, phase, stream); }
+
+        template<class T>
+        T&                      state                       ();
+    };
+
+    inline SimulationContext* SimulationContext::current() {
+        if (_current != nullptr) {
+            return _current;
+        }
+        static SimulationContext process;
+        return &process;
+    }
+
+    template<class T>
+    T& SimulationContext::state() {
+        std::lock_guard<std::mutex> lock(_stateLock);
+        std::shared_ptr<void> &entry = _state[std::type_index(typeid(T))];
+        if (!entry) {
+            entry = std::make_shared<T>();
+        }
+        return *static_cast<T*>(entry.get());
+    }
+
+    inline LogWriter* LogWriter::instance() {
+        return &SimulationContext::current()->log();
+    }
+}
+
+#endif // SimulationContext_hpp
@@ -0,0 +1,66 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// A reusable barrier for a fixed number of threads that spins instead of sleeping. It is used by the
+// pinned scheduler where every worker waits on it a few times per round, too often for a mutex and
+// condition variable. The last thread to arrive runs a completion function before the others are
+// released, which is where the serial parts of a round are done. Waiting threads yield after spinning
+// for a while so that an oversubscribed machine still makes progress.
+
+#ifndef SpinBarrier_hpp
+#define SpinBarrier_hpp
+
+#include <atomic>
+#include <thread>
+
+namespace quantas{
+
+    class SpinBarrier{
+    private:
+        const int                       _count;         // threads taking part
+        std::atomic<int>                _waiting;       // threads that arrived in the current generation
+        std::atomic<unsigned>           _generation;    // incremented each time the barrier opens
+
+        static const int                SPINS_BEFORE_YIELD = 4096;
+
+    public:
+        SpinBarrier                     (int count) : _count(count), _waiting(0), _generation(0) {};
+        SpinBarrier                     (const SpinBarrier&) = delete;
+        SpinBarrier&    operator=       (const SpinBarrier&) = delete;
+
+        // blocks until all threads arrived, the last one runs completion before releasing the others
+        template<class Completion>
+        void            wait            (Completion completion);
+        void            wait            ()                      {wait([]{});};
+    };
+
+    template<class Completion>
+    void SpinBarrier::wait(Completion completion){
+        const unsigned generation = _generation.load(std::memory_order_acquire);
+        if (_waiting.fetch_add(1, std::memory_order_acq_rel) == _count - 1) {
+            completion();
+            _waiting.store(0, std::memory_order_relaxed);
+            _generation.store(generation + 1, std::memory_order_release);
+            return;
+        }
+        int spins = 0;
+        while (_generation.load(std::memory_order_acquire) == generation) {
+            if (++spins < SPINS_BEFORE_YIELD) {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+#endif /* SpinBarrier_hpp */
@@ -11,23 +11,13 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int CycleOfTreesPeer::noOfEdges                = 0;
-	int CycleOfTreesPeer::noOfCycleNodes           = 0;
-	int                   numberOfNodes            = 0;
-	vector<list<int>>     allEdges;
-	vector<list<int>>     unusedEdges;
-	vector<list<int>>     presentEdges;
-	double                avgKnotOutputNumerator   = 0;
-	double                avgKnotOutputDenominator = 0;
-	bool                  firstDetected            = false;
-
 	CycleOfTreesPeer::~CycleOfTreesPeer() {}
 
-	CycleOfTreesPeer::CycleOfTreesPeer(const CycleOfTreesPeer& rhs) : Peer<CycleOfTreesMessage>(rhs) {
+	CycleOfTreesPeer::CycleOfTreesPeer(const CycleOfTreesPeer& rhs) : Peer<CycleOfTreesMessage>(rhs), shared(rhs.shared) {
 
 	}
 
-	CycleOfTreesPeer::CycleOfTreesPeer(long id) : Peer(id) {
+	CycleOfTreesPeer::CycleOfTreesPeer(long id) : Peer(id), shared(sharedState<CycleOfTreesShared>()) {
 
 	}
 
@@ -41,8 +31,8 @@ namespace quantas {
 
 		// numberOfEdges = number of edges per round
 		// cycleSize = number of nodes in knot/cycle
-		int cycleSize = noOfCycleNodes = parameters["cycleSize"];
-		int numberOfEdges = noOfEdges = parameters["numberOfEdges"];
+		int cycleSize = shared.noOfCycleNodes = parameters["cycleSize"];
+		int numberOfEdges = shared.noOfEdges = parameters["numberOfEdges"];
 
 		if (numberOfEdges > peers.size() || numberOfEdges <= 0) {
 			cout << "invalid input for number of edges; must be in interval [1, network size]" << endl;
@@ -54,19 +44,19 @@ namespace quantas {
 
 		// create cycle
                 for (int i = 1; i < cycleSize; ++i) {
-			allEdges.push_back(list<int>{(i - 1), i});
+			shared.allEdges.push_back(list<int>{(i - 1), i});
                 }
-		allEdges.push_back(list<int>{(cycleSize - 1), 0});
+		shared.allEdges.push_back(list<int>{(cycleSize - 1), 0});
 
                 // create random trees
-		numberOfNodes = _peers.size();
+		shared.numberOfNodes = _peers.size();
                 int positionedPeerID = 0;
-                for (int i = cycleSize; i < numberOfNodes; ++i) {
+                for (int i = cycleSize; i < shared.numberOfNodes; ++i) {
 			positionedPeerID = uniformInt(0, (i - 1));    // interval: [0, i - 1]
-			allEdges.push_back(list<int>{positionedPeerID, i});
+			shared.allEdges.push_back(list<int>{positionedPeerID, i});
                 }
 
-		unusedEdges = allEdges;
+		shared.unusedEdges = shared.allEdges;
 
 		pickEdges();
 	}
@@ -76,31 +66,31 @@ namespace quantas {
 
 		pickEdges();
 
-		if (firstDetected == false) {
+		if (shared.firstDetected == false) {
 			for(auto it = peers.begin(); it != peers.end(); ++it) {
 					if ((*it)->highestID != -1) {
-						cout << "Number of allowed edges is " << noOfEdges << " and knot size is " << noOfCycleNodes << endl;
+						cout << "Number of allowed edges is " << shared.noOfEdges << " and knot size is " << shared.noOfCycleNodes << endl;
 						cout << "\t Number of rounds till the cycle is first detected: " << (getRound() + 1) << endl;    // plus one since QUANTAS starts at round 0
-						firstDetected = true;
+						shared.firstDetected = true;
 						break;
 					}
 			}
 		}
 
 		if (lastRound()) {
-			if (!firstDetected) {
+			if (!shared.firstDetected) {
 				cout << "No node detected the knot; try a longer computation length." << endl;
 			}
 
-			firstDetected = false;
+			shared.firstDetected = false;
 			
-			avgKnotOutputNumerator   = 0;
-			avgKnotOutputDenominator = 0;
-			numberOfNodes            = 0;
+			shared.avgKnotOutputNumerator   = 0;
+			shared.avgKnotOutputDenominator = 0;
+			shared.numberOfNodes            = 0;
 
-			allEdges.clear();
-			unusedEdges.clear();
-			presentEdges.clear();
+			shared.allEdges.clear();
+			shared.unusedEdges.clear();
+			shared.presentEdges.clear();
 
 			/*cout << "Highest ID is: ";    // testing every node has detected the same highest ID
 			std::for_each(peers.begin(), peers.end(),
@@ -141,7 +131,7 @@ namespace quantas {
 
 		if (highestID == -1) {   // the cycle has not been detected yet
 			message.nodesMessageHasReached = nodesHeardFrom;
-			std::for_each(presentEdges.begin(), presentEdges.end(), [=](list<int> edge) {
+			std::for_each(shared.presentEdges.begin(), shared.presentEdges.end(), [=](list<int> edge) {
 				if (edge.front() == id()) {
 					unicastTo(message, edge.back());
 				}
@@ -150,7 +140,7 @@ namespace quantas {
 
 		else {    // the cycle has been detected
 			message.highestIdInKnot = highestID;
-			std::for_each(presentEdges.begin(), presentEdges.end(), [=](list<int> edge) {
+			std::for_each(shared.presentEdges.begin(), shared.presentEdges.end(), [=](list<int> edge) {
 				if (edge.front() == id()) {
 					unicastTo(message, edge.back());
 				}
@@ -162,39 +152,39 @@ namespace quantas {
 	// then every [floor(n/m) + 1] rounds there will only be [n – (floor(n/m)*m)] edge(s).
 	void CycleOfTreesPeer::pickEdges() {
 
-		presentEdges.clear();
+		shared.presentEdges.clear();
 
-		if (unusedEdges.empty()) {
-			unusedEdges = allEdges;
+		if (shared.unusedEdges.empty()) {
+			shared.unusedEdges = shared.allEdges;
 		}
 
-		std::shuffle(unusedEdges.begin(), unusedEdges.end(), RANDOM_GENERATOR);
+		std::shuffle(shared.unusedEdges.begin(), shared.unusedEdges.end(), RANDOM_GENERATOR);
 
 		int i = 0;
-		auto it = unusedEdges.begin();
-		while (i < noOfEdges) {
-			if (it == unusedEdges.end()) {
+		auto it = shared.unusedEdges.begin();
+		while (i < shared.noOfEdges) {
+			if (it == shared.unusedEdges.end()) {
 				break;
 			}
 
-			presentEdges.push_back(std::move(*it));
-			it = unusedEdges.erase(it);
+			shared.presentEdges.push_back(std::move(*it));
+			it = shared.unusedEdges.erase(it);
 			++i;
 		}
 	}
 
 	void CycleOfTreesPeer::setHighestID(int ID) {
 		highestID = ID;
-		avgKnotOutputNumerator += (getRound() + 1);    // plus one since QUANTAS starts at round 0
+		shared.avgKnotOutputNumerator += (getRound() + 1);    // plus one since QUANTAS starts at round 0
 
-		if (avgKnotOutputDenominator == numberOfNodes - 1) {
+		if (shared.avgKnotOutputDenominator == shared.numberOfNodes - 1) {
 			cout << "\t Number of rounds till the cycle is last detected: " << (getRound() + 1) << endl;    // plus one since QUANTAS starts at round 0
 		}
 
-		++avgKnotOutputDenominator;
+		++shared.avgKnotOutputDenominator;
 
-		if (avgKnotOutputDenominator == numberOfNodes) {
-			cout << "\t Average number of rounds for node to detect knot: " << avgKnotOutputNumerator / avgKnotOutputDenominator << endl;
+		if (shared.avgKnotOutputDenominator == shared.numberOfNodes) {
+			cout << "\t Average number of rounds for node to detect knot: " << shared.avgKnotOutputNumerator / shared.avgKnotOutputDenominator << endl;
 		}
 	}
 
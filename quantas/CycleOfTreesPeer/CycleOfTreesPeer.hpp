@@ -10,6 +10,7 @@ You should have received a copy of the GNU General Public License along with QUA
 #define CycleOfTreesPeer_hpp
 
 #include <set>
+#include <list>
 #include <iostream>
 #include "../Common/Peer.hpp"
 #include "../Common/Simulation.hpp"
@@ -25,6 +26,24 @@ namespace quantas {
     struct CycleOfTreesMessage {
         set<int> nodesMessageHasReached = {};
         int      highestIdInKnot        = -1;
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t   size                   () const {return messageSize(nodesMessageHasReached) + messageSize(highestIdInKnot);};
+    };
+
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct CycleOfTreesShared {
+        // total number of edges in the backbone topology
+        int                noOfEdges = 0;
+        // total number of nodes in the cycle (knot)
+        int                noOfCycleNodes = 0;
+        int                numberOfNodes = 0;
+        vector<list<int>>  allEdges;
+        vector<list<int>>  unusedEdges;
+        vector<list<int>>  presentEdges;
+        double             avgKnotOutputNumerator = 0;
+        double             avgKnotOutputDenominator = 0;
+        bool               firstDetected = false;
     };
 
     class CycleOfTreesPeer : public Peer<CycleOfTreesMessage> {
@@ -51,10 +70,8 @@ namespace quantas {
         // nodes you have received messages from
         set<int>             nodesHeardFrom = { id() };
 
-        // total number of edges in the backbone topology
-        static int           noOfEdges;
-        // total number of nodes in the cycle (knot)
-        static int           noOfCycleNodes;
+        // values shared with the other peers of the simulation
+        CycleOfTreesShared&  shared;
 
         // checkInStrm checks messages
         void                 checkInStrm ();
@@ -12,13 +12,11 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int  DynamicPeer::acceptedBlocks  = 0;
-
 	DynamicPeer::~DynamicPeer() {}
 
-	DynamicPeer::DynamicPeer(const DynamicPeer& rhs) : Peer<DynamicMessage>(rhs) {}
+	DynamicPeer::DynamicPeer(const DynamicPeer& rhs) : Peer<DynamicMessage>(rhs), shared(rhs.shared) {}
 
-	DynamicPeer::DynamicPeer(long id) : Peer(id) {
+	DynamicPeer::DynamicPeer(long id) : Peer(id), shared(sharedState<DynamicShared>()) {
 		DynamicBlock genesis;
 		genesis.depth = 1;
 		blockChain.push_back(genesis);
@@ -39,7 +37,7 @@ namespace quantas {
 	void DynamicPeer::endOfRound(const vector<Peer<DynamicMessage>*>& _peers) {
 		const vector<DynamicPeer*> peers = reinterpret_cast<vector<DynamicPeer*> const&>(_peers);
 		bool  flag  = true;
-		int   index = acceptedBlocks + 1;
+		int   index = shared.acceptedBlocks + 1;
 
 		for ( ; index < blockChain.size(); ++index) {
 			for (int i = 0; i < peers.size(); ++i) {
@@ -61,14 +59,14 @@ namespace quantas {
 			}
 
 			else {
-				++acceptedBlocks;
+				++shared.acceptedBlocks;
 			}
 		}
 
-                cout << "Round: " << getRound() << "; Accepted Blocks: " << acceptedBlocks << endl;
+                cout << "Round: " << getRound() << "; Accepted Blocks: " << shared.acceptedBlocks << endl;
     
 		if (lastRound()) {
-			acceptedBlocks = 0;
+			shared.acceptedBlocks = 0;
 		}
 	}
 
@@ -30,6 +30,15 @@ namespace quantas {
 
     struct DynamicMessage {
         vector<DynamicBlock>         blockChain          {};        // sender's blockchain
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t                       size                () const {return messageSize(blockChain);};
+    };
+
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct DynamicShared {
+        // number of accepted blocks (excluding gensis block). A block is considered accepted if all nodes have received said block and are mining on top of it
+        int  acceptedBlocks = 0;
     };
 
     class DynamicPeer : public Peer<DynamicMessage> {
@@ -55,8 +64,8 @@ namespace quantas {
         vector<DynamicBlock>         blockChain;        
         // rate at which blocks are mine (i.e., 1 in x chance for all n nodes)
         int                          mineRate            = 40;
-        // number of accepted blocks (excluding gensis block). A block is considered accepted if all nodes have received said block and are mining on top of it
-        static int                   acceptedBlocks;
+        // values shared with the other peers of the simulation
+        DynamicShared&               shared;
         
         // checkInStrm checks messages
         void                 checkInStrm        ();
@@ -13,18 +13,15 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int EthereumPeer::currentTransaction = 1;
-	mutex EthereumPeer::currentTransaction_mutex;
-
 	EthereumPeer::~EthereumPeer() {
 
 	}
 
-	EthereumPeer::EthereumPeer(const EthereumPeer& rhs) : Peer<EthereumPeerMessage>(rhs) {
+	EthereumPeer::EthereumPeer(const EthereumPeer& rhs) : Peer<EthereumPeerMessage>(rhs), shared(rhs.shared) {
 		
 	}
 
-	EthereumPeer::EthereumPeer(long id) : Peer(id) {
+	EthereumPeer::EthereumPeer(long id) : Peer(id), shared(sharedState<EthereumShared>()) {
 		
 	}
 
@@ -115,10 +112,10 @@ namespace quantas {
 	}
 
 	void EthereumPeer::submitTrans() {
-		const lock_guard<mutex> lock(currentTransaction_mutex);
+		const lock_guard<mutex> lock(shared.currentTransaction_mutex);
 		EthereumPeerMessage message;
 		message.mined = false;
-		message.block.trans.id = currentTransaction++;
+		message.block.trans.id = shared.currentTransaction++;
 		message.block.trans.roundSubmitted = getRound();
 		broadcast(message);
 	}
@@ -36,12 +36,25 @@ namespace quantas{
         vector<int>         tipLengths  = vector<int>(); // the lengths of the tip blocks
 
         int                 length      = 0;  // the length of the blockchain
+
+        // bytes the block takes when sent (see MessageSize.hpp)
+        size_t              size        () const {return messageSize(minerId) + messageSize(trans) + messageSize(tipMiners) + messageSize(tipLengths) + messageSize(length);};
     };
 
     struct EthereumPeerMessage {
 
         EtherBlock			block; // the block being sent
         bool				mined = false; // decides if it's a mined block or submitted transaction
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t				size() const {return messageSize(block) + messageSize(mined);};
+    };
+
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct EthereumShared {
+        // the id of the next transaction to submit
+        int    currentTransaction = 1;
+        mutex  currentTransaction_mutex;
     };
 
     class EthereumPeer : public Peer<EthereumPeerMessage>{
@@ -73,9 +86,8 @@ namespace quantas{
         int                   submitRate = 20;
         // rate at which to mine blocks ie 1 in x chance for all n nodes
         int                   mineRate = 40;
-        // the id of the next transaction to submit
-        static int            currentTransaction;
-        static mutex          currentTransaction_mutex;
+        // values shared with the other peers of the simulation
+        EthereumShared&       shared;
 
         // checkInStrm loops through the in stream adding blocks to unlinked or transactions
         void                  checkInStrm();
@@ -34,7 +34,7 @@ namespace quantas {
 		msg.aPeerId = std::to_string(id());
 		Packet<ExampleMessage> newMsg(getRound(), id(), id());
 		newMsg.setMessage(msg);
-		pushToOutSteam(newMsg);
+		pushToOutStream(std::move(newMsg));
 
 		// Send hello to everyone else
 		msg.message = "Message: Hello From " + std::to_string(id()) + ". Sent on round: " + std::to_string(getRound());
@@ -26,6 +26,9 @@ namespace quantas{
         
         string aPeerId;
         string message;
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t size() const {return messageSize(aPeerId) + messageSize(message);};
         
     };
 
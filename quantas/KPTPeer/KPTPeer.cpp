@@ -34,7 +34,7 @@ namespace quantas {
 
 		KPTBlockLabel blockLabel;
 		blockLabel.block = genesis;
-		blockLabel.label = "accepted";
+		blockLabel.label = KPTLabel::accepted;
 		perBlockLabels.push_back(blockLabel);
 	}
 
@@ -149,7 +149,7 @@ namespace quantas {
 				if ((2*PT) <= (getRound() - (*branch)[branch->size() - 1].roundMined)) {
 					for (int i = 0; i < branch->size(); ++i) {
 						if (blockChain[i] != (*branch)[i]) {
-							updatePerBlockLabels((*branch)[i], "rejected");
+							updatePerBlockLabels((*branch)[i], KPTLabel::rejected);
 						}
 					}
 
@@ -178,7 +178,7 @@ namespace quantas {
 				}
 
 				if (noCompetingBranches) {
-					updatePerBlockLabels(blockChain[index], "accepted");
+					updatePerBlockLabels(blockChain[index], KPTLabel::accepted);
 				}
 			}
 
@@ -188,7 +188,7 @@ namespace quantas {
 		}
 	}
 
-	void KPTPeer::updatePerBlockLabels(const KPTBlock& block, const string& label) {
+	void KPTPeer::updatePerBlockLabels(const KPTBlock& block, KPTLabel label) {
 		auto found = perBlockLabels.begin();
 		for ( ; found != perBlockLabels.end(); ++found) {
 			if (block == found->block && label == found->label) {
@@ -198,10 +198,10 @@ namespace quantas {
 
 		if (found == perBlockLabels.end()) {
 			bool flag = true;
-			if (label == "accepted") {
+			if (label == KPTLabel::accepted) {
 				auto it = perBlockLabels.begin();
 				for ( ; it != perBlockLabels.end(); ++it) {
-					if (block.tipMiner == it->block.minerId && (block.depth - 1) == it->block.depth && it->label == "accepted") {
+					if (block.tipMiner == it->block.minerId && (block.depth - 1) == it->block.depth && it->label == KPTLabel::accepted) {
 						break;
 					}
 				}
@@ -29,14 +29,20 @@ namespace quantas {
         bool                 operator==             (const KPTBlock&) const;
     };
 
+    // decision taken on a block
+    enum class KPTLabel { unlabeled, accepted, rejected };
+
     struct KPTBlockLabel {
         KPTBlock                            block;                           // block
-        string                              label          = "unlabeled";    // label of block
+        KPTLabel                            label          = KPTLabel::unlabeled; // label of block
     };
 
     struct KPTMessage {
         vector<KPTBlock>                    blockChain;                      // sender's blockchain
         vector<vector<KPTBlock>>            branches;                        // sender's branches
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t               size                   () const {return messageSize(blockChain) + messageSize(branches);};
     };
 
     class KPTPeer : public Peer<KPTMessage> {
@@ -81,7 +87,7 @@ namespace quantas {
         // updateBlockLabels iterates through a process' blockchain and branches and labels blocks appropriately
         void                 updateBlockLabels      ();
         // updatePerBlockLabels adds labeled block to perBlockLabels
-        void                 updatePerBlockLabels   (const KPTBlock&, const string&);
+        void                 updatePerBlockLabels   (const KPTBlock&, KPTLabel);
     };
 
     Simulation<quantas::KPTMessage, quantas::KPTPeer>* generateSim();
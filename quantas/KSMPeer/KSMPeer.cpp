@@ -22,7 +22,7 @@ namespace quantas {
 
 		KSMBlockLabel blockLabel;
 		blockLabel.block = genesis;
-		blockLabel.label = "accepted";
+		blockLabel.label = KSMLabel::accepted;
 		perBlockLabels.push_back(blockLabel);
 	}
 
@@ -217,13 +217,13 @@ namespace quantas {
 				}
 
 				if (counter == sourcePoolIds.size()) {
-					updatePerBlockLabels(blockChain[index], "accepted");
+					updatePerBlockLabels(blockChain[index], KSMLabel::accepted);
 				}
 			}
 		}
 	}
 
-	void KSMPeer::updatePerBlockLabels(const KSMBlock& block, const string& label) {
+	void KSMPeer::updatePerBlockLabels(const KSMBlock& block, KSMLabel label) {
 		auto found = perBlockLabels.begin();
 		for ( ; found != perBlockLabels.end(); ++found) {
 			if (block == found->block && label == found->label) {
@@ -233,10 +233,10 @@ namespace quantas {
 
 		if (found == perBlockLabels.end()) {
 			bool flag = true;
-			if (label == "accepted") {
+			if (label == KSMLabel::accepted) {
 				auto it = perBlockLabels.begin();
 				for ( ; it != perBlockLabels.end(); ++it) {
-					if (block.tipMiner == it->block.minerId && (block.depth - 1) == it->block.depth && it->label == "accepted") {
+					if (block.tipMiner == it->block.minerId && (block.depth - 1) == it->block.depth && it->label == KSMLabel::accepted) {
 						break;
 					}
 				}
@@ -30,15 +30,21 @@ namespace quantas {
         bool                 operator==             (const KSMBlock&) const;
     };
 
+    // decision taken on a block
+    enum class KSMLabel { unlabeled, accepted, rejected };
+
     struct KSMBlockLabel {
         KSMBlock                            block;                           // block
-        string                              label          = "unlabeled";    // corresponding label for block
+        KSMLabel                            label          = KSMLabel::unlabeled; // corresponding label for block
     };
 
     struct KSMMessage {
         vector<KSMBlock>                    blockChain;                      // sender's blockchain
         vector<vector<KSMBlock>>            branches;                        // sender's branches
         map<int, KSMBlock>                  sourcePoolPositions;             // sender's record of source pool members' positions
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t               size                   () const {return messageSize(blockChain) + messageSize(branches) + messageSize(sourcePoolPositions);};
     };
 
     class KSMPeer : public Peer<KSMMessage> {
@@ -87,7 +93,7 @@ namespace quantas {
         // updateBlockLabels iterates through a process' blockchain and branches and labels blocks appropriately
         void                 updateBlockLabels      ();
         // updatePerBlockLabels adds a labeled block to perBlockLabels
-        void                 updatePerBlockLabels   (const KSMBlock&, const string&);
+        void                 updatePerBlockLabels   (const KSMBlock&, KSMLabel);
     };
 
     Simulation<quantas::KSMMessage, quantas::KSMPeer>* generateSim();
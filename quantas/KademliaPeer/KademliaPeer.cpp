@@ -13,17 +13,15 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int KademliaPeer::currentTransaction = 1;
-
 	KademliaPeer::~KademliaPeer() {
 
 	}
 
-	KademliaPeer::KademliaPeer(const KademliaPeer& rhs) : Peer<KademliaMessage>(rhs) {
+	KademliaPeer::KademliaPeer(const KademliaPeer& rhs) : Peer<KademliaMessage>(rhs), shared(rhs.shared) {
 		
 	}
 
-	KademliaPeer::KademliaPeer(long id) : Peer(id) {
+	KademliaPeer::KademliaPeer(long id) : Peer(id), shared(sharedState<KademliaShared>()) {
 		
 	}
 
@@ -60,8 +58,8 @@ namespace quantas {
 			while (!inStreamEmpty()) {
 				Packet<KademliaMessage> packet = popInStream();
 				long source = packet.sourceId();
-				KademliaMessage message = packet.getMessage();
-				if (message.action == "R") {
+				KademliaMessage message = packet.takeMessage();
+				if (message.action == KademliaAction::request) {
 					if (id() == message.reqId) {
 						requestsSatisfied++;
 						latency += getRound() - message.roundSubmitted;
@@ -77,7 +75,7 @@ namespace quantas {
 
 	void KademliaPeer::endOfRound(const vector<Peer<KademliaMessage>*>& _peers) {
 		const vector<KademliaPeer*> peers = reinterpret_cast<vector<KademliaPeer*> const&>(_peers);
-		peers[randMod(neighbors().size()) + 1]->submitTrans(currentTransaction);
+		peers[randMod(neighbors().size()) + 1]->submitTrans(shared.currentTransaction);
 		double satisfied = 0;
 		double hops = 0;
 		for (int i = 0; i < peers.size(); i++) {
@@ -105,8 +103,8 @@ namespace quantas {
 	void KademliaPeer::sendMessage(long peer, KademliaMessage message) {
 		Packet<KademliaMessage> newMessage(getRound(), peer, id());
 		message.hops++;
-		newMessage.setMessage(message);
-		pushToOutSteam(newMessage);
+		newMessage.setMessage(std::move(message));
+		pushToOutStream(std::move(newMessage));
 	}
 
 	void KademliaPeer::submitTrans(int tranID) {
@@ -114,7 +112,7 @@ namespace quantas {
 		message.reqId = randMod(neighbors().size() + 1);
 		string binId = getBinaryId(message.reqId);
 		message.binId = binId;
-		message.action = "R";
+		message.action = KademliaAction::request;
 		message.roundSubmitted = getRound();
 		if (id() == message.reqId) {
 			requestsSatisfied++;
@@ -123,7 +121,7 @@ namespace quantas {
 		else {
 			sendMessage(findRoute(message.binId), message);
 		}
-		currentTransaction++;
+		shared.currentTransaction++;
 	}
 
 	long KademliaPeer::findRoute(string binId) {
@@ -16,12 +16,18 @@ You should have received a copy of the GNU General Public License along with QUA
 namespace quantas {
 
 
+	// R: a request routed towards reqId, N: reqId is a neighbor of the receiver
+	enum class KademliaAction { none, request, neighbor };
+
 	struct KademliaMessage {
 		long reqId;    // id the request is for
 		string binId;  // binary id of reqId
-		string action; // options are R, N
+		KademliaAction action = KademliaAction::none;
 		int roundSubmitted;
 		int hops = 0; // number of times this message has been echoed
+
+		// bytes the message takes when sent (see MessageSize.hpp)
+		size_t size() const {return messageSize(reqId) + messageSize(binId) + messageSize(action) + messageSize(roundSubmitted) + messageSize(hops);};
 	};
 
 	struct KademliaFinger {
@@ -29,6 +35,12 @@ namespace quantas {
 		string binId;		  // binary id of a finger
 		int group;			  // the level the finger belongs to (binary id difference)
 	};
+	// values shared by the peers of one simulation, they live in its SimulationContext
+	struct KademliaShared {
+		// the id of the next transaction to submit
+		int  currentTransaction = 1;
+	};
+
 	class KademliaPeer : public Peer<KademliaMessage> {
 	public:
 		// methods that must be defined when deriving from Peer
@@ -46,8 +58,8 @@ namespace quantas {
 		ostream& printTo(ostream&)const;
 		friend ostream& operator<<         (ostream&, const KademliaPeer&);
 
-		// the id of the next transaction to submit
-		static int currentTransaction;
+		// values shared with the other peers of the simulation
+		KademliaShared& shared;
 		// size of binary ids
 		int	binaryIdSize;
 		// list of nodes list of nodes in different trees than current node
@@ -12,18 +12,15 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int LinearChordPeer::currentTransaction = 1;
-	int LinearChordPeer::numberOfNodes = 0;
-
 	LinearChordPeer::~LinearChordPeer() {
 
 	}
 
-	LinearChordPeer::LinearChordPeer(const LinearChordPeer& rhs) : Peer<LinearChordMessage>(rhs) {
+	LinearChordPeer::LinearChordPeer(const LinearChordPeer& rhs) : Peer<LinearChordMessage>(rhs), shared(rhs.shared) {
 		
 	}
 
-	LinearChordPeer::LinearChordPeer(long id) : Peer(id) {
+	LinearChordPeer::LinearChordPeer(long id) : Peer(id), shared(sharedState<LinearChordShared>()) {
 		
 	}
 
@@ -54,9 +51,9 @@ namespace quantas {
 			while (!inStreamEmpty()) {
 				Packet<LinearChordMessage> packet = popInStream();
 				long source = packet.sourceId();
-				LinearChordMessage message = packet.getMessage();
+				LinearChordMessage message = packet.takeMessage();
 				long reqId = message.reqId;
-				if (message.action == "R") {
+				if (message.action == LinearChordAction::request) {
 					if (id() == reqId) {
 						requestsSatisfied++;
 						latency += getRound() - message.roundSubmitted;
@@ -169,7 +166,7 @@ namespace quantas {
 
 					if (added) {
 						LinearChordMessage response;
-						response.action = "N";
+						response.action = LinearChordAction::neighbor;
 						for (int i = 0; i < successor.size(); i++) {
 							if (successor[i].Id != reqId) {
 								sendMessage(successor[i].Id, message);
@@ -207,8 +204,8 @@ namespace quantas {
 
 	void LinearChordPeer::endOfRound(const vector<Peer<LinearChordMessage>*>& _peers) {
 		const vector<LinearChordPeer*> peers = reinterpret_cast<vector<LinearChordPeer*> const&>(_peers);
-		numberOfNodes = peers.size();
-		peers[randMod(numberOfNodes)]->submitTrans(currentTransaction);
+		shared.numberOfNodes = peers.size();
+		peers[randMod(shared.numberOfNodes)]->submitTrans(shared.currentTransaction);
 		double satisfied = 0;
 		double hops = 0;
 		for (int i = 0; i < peers.size(); i++) {
@@ -221,7 +218,7 @@ namespace quantas {
 	void LinearChordPeer::heartBeat() {
 		if (alive) {
 			LinearChordMessage message;
-			message.action = "N";
+			message.action = LinearChordAction::neighbor;
 			message.reqId = id();
 			for (int i = 0; i < successor.size(); i++) {
 				if (successor[i].roundUpdated + 20 > getRound()) {
@@ -247,15 +244,15 @@ namespace quantas {
 	void LinearChordPeer::sendMessage(long peer, LinearChordMessage message) {
 		Packet<LinearChordMessage> newMessage(getRound(), peer, id());
 		message.hops++;
-		newMessage.setMessage(message);
-		pushToOutSteam(newMessage);
+		newMessage.setMessage(std::move(message));
+		pushToOutStream(std::move(newMessage));
 	}
 
 	void LinearChordPeer::submitTrans(int tranID) {
 		LinearChordMessage message;
-		message.reqId = randMod(numberOfNodes);
+		message.reqId = randMod(shared.numberOfNodes);
 		long reqId = message.reqId;
-		message.action = "R";
+		message.action = LinearChordAction::request;
 		message.roundSubmitted = getRound();
 		if (id() == reqId) {
 			requestsSatisfied++;
@@ -278,7 +275,7 @@ namespace quantas {
 		else {
 			sendMessage(id(), message);
 		}
-		currentTransaction++;
+		shared.currentTransaction++;
 	}
 
 	std::ostream& LinearChordPeer::printTo(std::ostream& out)const {
@@ -16,9 +16,12 @@ You should have received a copy of the GNU General Public License along with QUA
 namespace quantas {
 
 
+	// R: a request routed towards reqId, N: reqId is a neighbor of the receiver
+	enum class LinearChordAction { none, request, neighbor };
+
 	struct LinearChordMessage {
 		long reqId;
-		std::string action; // options are R, N
+		LinearChordAction action = LinearChordAction::none;
 		int roundSubmitted;
 		int hops = 0; // number of times this message has been echoed
 	};
@@ -27,6 +30,14 @@ namespace quantas {
 		long Id;
 		int roundUpdated = 0; // round the finger was last updated
 	};
+	// values shared by the peers of one simulation, they live in its SimulationContext
+	struct LinearChordShared {
+		// the id of the next transaction to submit
+		int  currentTransaction = 1;
+		// number of peers in the network
+		int  numberOfNodes = 0;
+	};
+
 	class LinearChordPeer : public Peer<LinearChordMessage> {
 	public:
 		// methods that must be defined when deriving from Peer
@@ -44,8 +55,8 @@ namespace quantas {
 		ostream& printTo(ostream&)const;
 		friend ostream& operator<<         (ostream&, const LinearChordPeer&);
 
-		// the id of the next transaction to submit
-		static int                      currentTransaction;
+		// values shared with the other peers of the simulation
+		LinearChordShared&              shared;
 		// list of nodes with 'higher' id than current node
 		std::vector<LinearChordFinger> successor;
 		// list of nodes with 'lower' id than current node
@@ -58,7 +69,6 @@ namespace quantas {
 		int latency = 0;
 		// redundancy link number
 		int redundantSize = 2;
-		static int numberOfNodes;
 		// status of node
 		bool alive = true;
 		// sent every x rounds to indicate node is alive
@@ -12,17 +12,13 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-    int PBFTPeer::currentTransaction = 1;
-    int PBFTPeer::maxCrashes = 0;
-    int PBFTPeer::timeout = 0;
-
     PBFTPeer::~PBFTPeer() {
     }
 
-    PBFTPeer::PBFTPeer(const PBFTPeer &rhs) : Peer<PBFTPeerMessage>(rhs) {
+    PBFTPeer::PBFTPeer(const PBFTPeer &rhs) : Peer<PBFTPeerMessage>(rhs), shared(rhs.shared) {
     }
 
-    PBFTPeer::PBFTPeer(long id) : Peer(id) {
+    PBFTPeer::PBFTPeer(long id) : Peer(id), shared(sharedState<PBFTShared>()) {
     }
 
     void PBFTPeer::performComputation() {
@@ -30,13 +26,13 @@ namespace quantas {
         // maxCrashes is achieved either earlier or once 90% of rounds are done
         const int randNum = randMod(100);
         int chance = (getRound() / (getLastRound() * 0.90)) * 100;
-        if ((id() < maxCrashes) && !crashed && (randNum < chance)) {
+        if ((id() < shared.maxCrashes) && !crashed && (randNum < chance)) {
             crashed = true;
         }
         if (crashed) { return; }
 
         if (id() == leaderId && getRound() == 0) {
-            submitTrans(currentTransaction);
+            submitTrans(shared.currentTransaction);
         }
         checkInStrm();
         checkContents();
@@ -44,15 +40,15 @@ namespace quantas {
 
     void PBFTPeer::initParameters(const vector<Peer<PBFTPeerMessage> *> &_peers, json parameters) {
         if (parameters.contains("maxCrashes")) {
-            maxCrashes = parameters["maxCrashes"];
+            shared.maxCrashes = parameters["maxCrashes"];
         }
         if (parameters.contains("timeout")) {
-            timeout = parameters["timeout"];
+            shared.timeout = parameters["timeout"];
         }
 
         const vector<PBFTPeer *> peers = reinterpret_cast<vector<PBFTPeer *> const &>(_peers);
         for (int i = 0; i < peers.size(); ++i) {
-            peers[i]->view_changeTimeout = timeout;
+            peers[i]->view_changeTimeout = shared.timeout;
         }
     }
 
@@ -156,7 +152,7 @@ namespace quantas {
                     latency += getRound() - receivedMessages[sequenceNum][0].roundSubmitted;
                     sequenceNum++;
                     if (id() == leaderId) {
-                        submitTrans(currentTransaction);
+                        submitTrans(shared.currentTransaction);
                     }
                     checkContents();
                     paused = false;
@@ -168,11 +164,11 @@ namespace quantas {
         if (!paused) { ++timer; }
 
         // calculate the view-change timeout (v+1: 1T, v+2: 2T, . . . , v+k: kT)
-        if ((viewJumps > 1) && (view_changeTimeout / timeout) == (viewJumps - 1)) {
-            view_changeTimeout += timeout;
+        if ((shared.timeout > 0) && (viewJumps > 1) && (view_changeTimeout / shared.timeout) == (viewJumps - 1)) {
+            view_changeTimeout += shared.timeout;
         }
 
-        if (timer >= view_changeTimeout) { // send view-change
+        if ((shared.timeout > 0) && (timer >= view_changeTimeout)) { // send view-change
             timer = 0;
             ++viewJumps;
             candidateId = (viewNum + viewJumps) % (neighbors().size() + 1);
@@ -183,7 +179,7 @@ namespace quantas {
                 timer = 0;
                 viewJumps = 0;
                 viewNum = message.viewNum;
-                view_changeTimeout = timeout;
+                view_changeTimeout = shared.timeout;
                 leaderId = (viewNum) % (neighbors().size() + 1);
                 candidateId = (viewNum + 1) % (neighbors().size() + 1);
                 receivedMessages.pop_back();
@@ -202,7 +198,7 @@ namespace quantas {
                 // Upon 2f+1 view-changes, leader of the next view broadcasts a new-view
                 if (count >= 2 * (neighbors().size() / 3) + 1) {
                     submitViewChange(messageType::new_view);
-                    submitTrans(currentTransaction);
+                    submitTrans(shared.currentTransaction);
                 }
             }
         }
@@ -216,7 +212,7 @@ namespace quantas {
         message.roundSubmitted = getRound();
         broadcast(message);
         transactions.push_back(message);
-        currentTransaction++;
+        shared.currentTransaction++;
     }
 
     // submits either "view_change" or "new_view"
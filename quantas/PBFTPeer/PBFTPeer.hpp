@@ -29,6 +29,16 @@ namespace quantas{
         int                 roundSubmitted;
     };
 
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct PBFTShared {
+        // max amount of peers that *can* crash in a single test
+        int  maxCrashes = 0;
+        // amount of rounds before sending a view-change msg, 0 never sends one
+        int  timeout = 0;
+        // the id of the next transaction to submit
+        int  currentTransaction = 1;
+    };
+
     class PBFTPeer : public Peer<PBFTPeerMessage>{
     public:
         // methods that must be defined when deriving from Peer
@@ -80,14 +90,8 @@ namespace quantas{
         int                             latency = 0;
         // rate at which to submit transactions ie 1 in x chance for all n nodes
         int                             submitRate = 20;
-        // max amount of peers that *can* crash in a single test
-        static int                      maxCrashes;
-        // amount of rounds before sending a view-change msg
-        static int                      timeout;
-        
-        // the id of the next transaction to submit
-        static int                      currentTransaction;
-
+        // values shared with the other peers of the simulation
+        PBFTShared&                     shared;
 
         // checkInStrm loops through the in stream adding messsages to receivedMessages or transactions
         void                  checkInStrm();
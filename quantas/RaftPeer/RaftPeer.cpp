@@ -12,17 +12,15 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int RaftPeer::currentTransaction = 1;
-
 	RaftPeer::~RaftPeer() {
 
 	}
 
-	RaftPeer::RaftPeer(const RaftPeer& rhs) : Peer<RaftPeerMessage>(rhs) {
+	RaftPeer::RaftPeer(const RaftPeer& rhs) : Peer<RaftPeerMessage>(rhs), shared(rhs.shared) {
 		
 	}
 
-	RaftPeer::RaftPeer(long id) : Peer(id) {
+	RaftPeer::RaftPeer(long id) : Peer(id), shared(sharedState<RaftShared>()) {
 		
 	}
 
@@ -31,12 +29,12 @@ namespace quantas {
 			checkInStrm();
 
 		if (getRound() == 0) {
-			submitTrans(currentTransaction);
+			submitTrans(shared.currentTransaction);
 		}
 
 		if (timeOutRound <= getRound()) {
 			RaftPeerMessage newMsg;
-			newMsg.messageType = "elect";
+			newMsg.messageType = RaftMessageType::elect;
 			newMsg.Id = id();
 			candidate = id();
 			leaderId = -1;
@@ -45,6 +43,8 @@ namespace quantas {
 			resetTimer();
 			broadcast(newMsg);
 		}
+		// nothing to do until the next message or the timeout
+		idleUntil(timeOutRound);
 	}
 
 	void RaftPeer::endOfRound(const vector<Peer<RaftPeerMessage>*>& _peers) {
@@ -60,8 +60,8 @@ namespace quantas {
 
 	void RaftPeer::checkInStrm() {
 		while (!inStreamEmpty()) {
-			RaftPeerMessage Msg = popInStream().getMessage();
-			if (Msg.messageType == "request") {
+			RaftPeerMessage Msg = popInStream().takeMessage();
+			if (Msg.messageType == RaftMessageType::request) {
 				if (term <= Msg.termNum) {
 					term = Msg.termNum;
 					leaderId = Msg.Id;
@@ -69,22 +69,22 @@ namespace quantas {
 					candidate = -1;
 					resetTimer();
 					RaftPeerMessage newMsg;
-					newMsg.messageType = "respondRequest";
+					newMsg.messageType = RaftMessageType::respondRequest;
 					newMsg.trans = Msg.trans;
 					newMsg.Id = id();
 					newMsg.roundSubmitted = Msg.roundSubmitted;
 					sendMessage(Msg.Id, newMsg);
 				}
 			}
-			else if (Msg.messageType == "respondRequest") {
+			else if (Msg.messageType == RaftMessageType::respondRequest) {
 				replys[Msg.trans].push_back(Msg.Id);
 				if (replys[Msg.trans].size() == neighbors().size() / 2) {
 					requestsSatisfied++;
 					latency += getRound() - Msg.roundSubmitted;
-					submitTrans(currentTransaction);
+					submitTrans(shared.currentTransaction);
 				}
 			}
-			else if (Msg.messageType == "vote") {
+			else if (Msg.messageType == RaftMessageType::vote) {
 				if (leaderId != id()) {
 					if (Msg.trans == id()) {
 						votes.push_back(Msg.Id);
@@ -95,12 +95,12 @@ namespace quantas {
 							leaderId = id();
 							candidate = -1;
 							votes.clear();
-							submitTrans(currentTransaction);
+							submitTrans(shared.currentTransaction);
 						}
 					}
 				}
 			}
-			else if (Msg.messageType == "elect") {
+			else if (Msg.messageType == RaftMessageType::elect) {
 				if (term < Msg.termNum) {
 					// Reset timeout
 					leaderId = Msg.Id;
@@ -110,7 +110,7 @@ namespace quantas {
 					resetTimer();
 
 					RaftPeerMessage newMsg;
-					newMsg.messageType = "vote";
+					newMsg.messageType = RaftMessageType::vote;
 					newMsg.Id = id();
 					newMsg.termNum = Msg.termNum;
 					newMsg.roundSubmitted = Msg.roundSubmitted;
@@ -124,14 +124,14 @@ namespace quantas {
 	void RaftPeer::submitTrans(int tranID) {
 		if (leaderId == id()) {
 			RaftPeerMessage message;
-			message.messageType = "request";
+			message.messageType = RaftMessageType::request;
 			message.trans = tranID;
 			message.Id = id();
 			message.termNum = term;
 			message.roundSubmitted = getRound();
 			broadcast(message);
 			resetTimer();
-			currentTransaction++;
+			shared.currentTransaction++;
 		}
 	}
 
@@ -141,8 +141,8 @@ namespace quantas {
 
 	void RaftPeer::sendMessage(long peer, RaftPeerMessage message) {
 		Packet<RaftPeerMessage> newMessage(getRound(), peer, id());
-		newMessage.setMessage(message);
-		pushToOutSteam(newMessage);
+		newMessage.setMessage(std::move(message));
+		pushToOutStream(std::move(newMessage));
 	}
 
 	ostream& RaftPeer::printTo(ostream& out)const {
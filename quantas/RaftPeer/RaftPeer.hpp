@@ -16,15 +16,24 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas{
 
+    // what a Raft message asks of its receiver
+    enum class RaftMessageType { none, request, respondRequest, vote, elect };
+
     struct RaftPeerMessage {
 
         int 				Id = -1; // node who sent the message
         int					trans = -1; // the transaction id also used to indicate who a vote is for
         int                 termNum = -1;
-        string              messageType = ""; // vote, elect, request, respondRequest
+        RaftMessageType     messageType = RaftMessageType::none;
         int                 roundSubmitted;
     };
 
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct RaftShared {
+        // the id of the next transaction to submit
+        int  currentTransaction = 1;
+    };
+
     class RaftPeer : public Peer<RaftPeerMessage>{
     public:
         // methods that must be defined when deriving from Peer
@@ -44,8 +53,8 @@ namespace quantas{
         
         // id of the node voted as the next leader
         int                             candidate = -1;
-        // the id of the next transaction to submit
-        static int                      currentTransaction;
+        // values shared with the other peers of the simulation
+        RaftShared&                     shared;
         // number of requests satisfied
         int                             requestsSatisfied = 0;
         // latency of satisfied requests
@@ -11,14 +11,6 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int SmartShardsPeer::currentTransaction = 1;
-	mutex SmartShardsPeer::currentTransaction_mutex;
-	int SmartShardsPeer::nextJoiningNode = 0;
-	int SmartShardsPeer::numberOfShards = 0;
-	int SmartShardsPeer::churnRate = 0;
-	int SmartShardsPeer::maxLeaveDelay = 100;
-	int SmartShardsPeer::ChurnOption = 0;
-
 	template <typename Map>
 	bool key_compare(Map const& lhs, Map const& rhs) {
 		return lhs.size() == rhs.size()
@@ -30,11 +22,11 @@ namespace quantas {
 
 	}
 
-	SmartShardsPeer::SmartShardsPeer(const SmartShardsPeer& rhs) : Peer<SmartShardsMessage>(rhs) {
+	SmartShardsPeer::SmartShardsPeer(const SmartShardsPeer& rhs) : Peer<SmartShardsMessage>(rhs), shared(rhs.shared) {
 
 	}
 
-	SmartShardsPeer::SmartShardsPeer(long id) : Peer(id) {
+	SmartShardsPeer::SmartShardsPeer(long id) : Peer(id), shared(sharedState<SmartShardsShared>()) {
 
 	}
 
@@ -52,7 +44,7 @@ namespace quantas {
 
 			if (leaving) {
 				leaveDelay++;
-				if (leaveDelay >= maxLeaveDelay) {
+				if (leaveDelay >= shared.maxLeaveDelay) {
 					//cout << "Node " << id() << " LEFT WITHOUT PERMISSION -----------------------" << endl;
 					//cout << "Shards: ";
 					for (auto ip = shards.begin(); ip != shards.end(); ip++) {
@@ -80,9 +72,9 @@ namespace quantas {
 		// number of intersections = intersections
 		// total number of nodes n = intersections * s * (s - 1) / L
 		// nodes in a shard = (s - 1) * intersections
-		int s = numberOfShards = parameters["s"];
+		int s = shared.numberOfShards = parameters["s"];
 		int intersections = parameters["intersections"];
-		nextJoiningNode = intersections * s * (s - 1) / 2;
+		shared.nextJoiningNode = intersections * s * (s - 1) / 2;
 		vector<vector<int>> shardGrid(s);
 		int nextNode = 0;
 		for (int i = 0; i < shardGrid.size(); i++) {
@@ -97,7 +89,7 @@ namespace quantas {
 
 			for (int j = 0; j < shardGrid[i].size(); j++) {
 				peers[shardGrid[i][j]]->shards[i] = false;
-				peers[shardGrid[i][j]]->status[i] = "pre-prepare";
+				peers[shardGrid[i][j]]->status[i] = SmartShardsStatus::pre_prepare;
 				peers[shardGrid[i][j]]->workingTrans[i] = 0;
 				peers[shardGrid[i][j]]->alive = true;
 			}
@@ -124,13 +116,13 @@ namespace quantas {
 		}
 
 		if (parameters.contains("churnRate")) {
-			churnRate = parameters["churnRate"];
+			shared.churnRate = parameters["churnRate"];
 		}
 		if (parameters.contains("maxLeaveDelay")) {
-			maxLeaveDelay = parameters["maxLeaveDelay"];
+			shared.maxLeaveDelay = parameters["maxLeaveDelay"];
 		}
 		if (parameters.contains("ChurnOption")) {
-			ChurnOption = parameters["ChurnOption"];
+			shared.ChurnOption = parameters["ChurnOption"];
 		}
 	}
 
@@ -144,17 +136,17 @@ namespace quantas {
 		//		}
 		//	}
 		//}
-		if (churnRate != 0) {
+		if (shared.churnRate != 0) {
 			// Joins
-			for (int i = 0; i < churnRate; i++) {
-				SmartShardsPeer* nextNode = peers[nextJoiningNode++];
+			for (int i = 0; i < shared.churnRate; i++) {
+				SmartShardsPeer* nextNode = peers[shared.nextJoiningNode++];
 				set<int> churnApprovals;
 				int numberOfJoinRequests = 2;
-				if (ChurnOption == 1 || ChurnOption == 3) {
+				if (shared.ChurnOption == 1 || shared.ChurnOption == 3) {
 					numberOfJoinRequests = 1; // second join will be routed
 				}
 				while (churnApprovals.size() < numberOfJoinRequests) {
-					churnApprovals.insert(randMod(numberOfShards));
+					churnApprovals.insert(randMod(shared.numberOfShards));
 					nextNode->joining = true;
 					nextNode->alive = true;
 				}
@@ -165,7 +157,7 @@ namespace quantas {
 							if (peers[j]->shards[*ip]) { // send request directly to leader
 								nextNode->addNeighbor(_peers[j]->id()); // add node as a connection
 								SmartShardsMessage message;
-								message.messageType = "joinRequest";
+								message.messageType = SmartShardsMessageType::joinRequest;
 								message.Id = nextNode->id();
 								message.shard = *ip;
 								sendMessage(peers[j]->id(), message);
@@ -177,10 +169,10 @@ namespace quantas {
 			}
 
 			// Leaves
-			vector<int> options(nextJoiningNode);
-			for (int i = 0; i < nextJoiningNode; i++) options[i] = i;
-			shuffle(options.begin(), options.end(), default_random_engine{});
-			for (int i = 0; i < churnRate; i++) {
+			vector<int> options(shared.nextJoiningNode);
+			for (int i = 0; i < shared.nextJoiningNode; i++) options[i] = i;
+			shuffle(options.begin(), options.end(), std::default_random_engine{});
+			for (int i = 0; i < shared.churnRate; i++) {
 				if (options.size() == 0) {
 					// ran out of nodes able to churn
 					break;
@@ -210,7 +202,7 @@ namespace quantas {
 						if (peers[j]->shards.find(ip->first) != peers[j]->shards.end()) {
 							if (peers[j]->shards[ip->first]) { // send request directly to leaders
 								SmartShardsMessage message;
-								message.messageType = "leaveRequest";
+								message.messageType = SmartShardsMessageType::leaveRequest;
 								message.Id = leavingNode->id();
 								message.shard = ip->first;
 								sendMessage(peers[j]->id(), message);
@@ -258,14 +250,14 @@ namespace quantas {
 
 	void SmartShardsPeer::checkInStrm() {
 		while (!inStreamEmpty()) {
-			SmartShardsMessage newMsg = popInStream().getMessage();
+			SmartShardsMessage newMsg = popInStream().takeMessage();
 
-			if (newMsg.messageType == "trans") {
+			if (newMsg.messageType == SmartShardsMessageType::trans) {
 				transactions.push_back(newMsg);
 			}
-			else if (newMsg.messageType == "joinApproved") {
+			else if (newMsg.messageType == SmartShardsMessageType::joinApproved) {
 
-				status[newMsg.shard] = "pre-prepare";
+				status[newMsg.shard] = SmartShardsStatus::pre_prepare;
 				shards[newMsg.shard] = false;
 				members[newMsg.shard] = newMsg.members;
 				SmartShardsMember self;
@@ -283,7 +275,7 @@ namespace quantas {
 					timeToJoin += joinDelay;
 					joinDelay = 0;
 					SmartShardsMessage message;
-					message.messageType = "updateMember";
+					message.messageType = SmartShardsMessageType::updateMember;
 					message.Id = id();
 					message.members.push_back(self);
 					for (auto ip = shards.begin(); ip != shards.end(); ip++) {
@@ -294,25 +286,25 @@ namespace quantas {
 				}
 				workingTrans[newMsg.shard] = newMsg.trans;
 			}
-			else if (newMsg.messageType == "leaveRequest") {
-				churnRequests[newMsg.shard].push_back(std::make_pair("leave", newMsg.Id));
+			else if (newMsg.messageType == SmartShardsMessageType::leaveRequest) {
+				churnRequests[newMsg.shard].push_back(std::make_pair(SmartShardsChurn::leave, newMsg.Id));
 			}
-			else if (newMsg.messageType == "joinRequest") {
+			else if (newMsg.messageType == SmartShardsMessageType::joinRequest) {
 				int shard = newMsg.shard;
 				if (shards[newMsg.shard]) {
-					churnRequests[shard].push_back(std::make_pair("join", newMsg.Id));
+					churnRequests[shard].push_back(std::make_pair(SmartShardsChurn::join, newMsg.Id));
 					// need to find other shards for node
-					if (ChurnOption == 1) {
+					if (shared.ChurnOption == 1) {
 						bool foundShards = false;
 						for (int j = 0; j < churnRequests[shard].size(); j++) {
-							if (churnRequests[shard][j].first == "leave") {
+							if (churnRequests[shard][j].first == SmartShardsChurn::leave) {
 								for (int k = 0; k < members[shard].size(); k++) {
 									if (members[shard][k].Id == churnRequests[shard][j].second) {
 
 										for (auto ip = members[shard][k].shards.begin(); ip != members[shard][k].shards.end(); ip++) {
 											if (*ip != shard) {
 												SmartShardsMessage joinRequestMessage;
-												joinRequestMessage.messageType = "joinRequest2";
+												joinRequestMessage.messageType = SmartShardsMessageType::joinRequest2;
 												joinRequestMessage.Id = newMsg.Id;
 												joinRequestMessage.shard = *ip;
 												//cout << "Node " << id() << " creating joinrequest2 fill hole to shard " << *ip << " for node " << newMsg.Id << " send to " << members[shard][j].Id << endl;
@@ -338,19 +330,19 @@ namespace quantas {
 						if (!foundShards) {
 							int otherShard;
 							do {
-								otherShard = randMod(numberOfShards);
+								otherShard = randMod(shared.numberOfShards);
 							} while (otherShard == shard);
 							// if the leader is in the other shard
 							if (shards.find(otherShard) != shards.end()) {
 								if (shards[otherShard]) {
-									churnRequests[otherShard].push_back(std::make_pair("join2", newMsg.Id));
+									churnRequests[otherShard].push_back(std::make_pair(SmartShardsChurn::join2, newMsg.Id));
 								}
 								else {
 									for (int j = 0; j < members[otherShard].size(); j++) {
 										if (members[otherShard][j].leader == true) {
 											SmartShardsMessage joinRequestMessage;
 											//cout << "Node " << id() << " creating joinrequest2 in both to shard " << otherShard << " for node " << newMsg.Id << " send to " << members[otherShard][j].Id << endl;
-											joinRequestMessage.messageType = "joinRequest2";
+											joinRequestMessage.messageType = SmartShardsMessageType::joinRequest2;
 											joinRequestMessage.Id = newMsg.Id;
 											joinRequestMessage.shard = otherShard;
 											sendMessage(members[otherShard][j].Id, joinRequestMessage);
@@ -364,7 +356,7 @@ namespace quantas {
 								for (int j = 0; j < members[shard].size(); j++) {
 									if (members[shard][j].shards.find(otherShard) != members[shard][j].shards.end()) {
 										SmartShardsMessage joinRequestMessage;
-										joinRequestMessage.messageType = "joinRequest2";
+										joinRequestMessage.messageType = SmartShardsMessageType::joinRequest2;
 										joinRequestMessage.Id = newMsg.Id;
 										joinRequestMessage.shard = otherShard;
 										sendMessage(members[shard][j].Id, joinRequestMessage);
@@ -375,7 +367,7 @@ namespace quantas {
 							}
 						}
 					}
-					else if (ChurnOption == 3) {
+					else if (shared.ChurnOption == 3) {
 						map<int, int> potentialShardSizes;
 						for (int j = 0; j < members[shard].size(); j++) {
 							for (auto ip = members[shard][j].shards.begin(); ip != members[shard][j].shards.end(); ip++) {
@@ -388,7 +380,7 @@ namespace quantas {
 							}
 						}
 						for (int j = 0; j < churnRequests[shard].size(); j++) {
-							if (churnRequests[shard][j].first == "leave") {
+							if (churnRequests[shard][j].first == SmartShardsChurn::leave) {
 								for (int k = 0; k < members[shard].size(); k++) {
 									for (int k = 0; k < members[shard].size(); k++) {
 										if (members[shard][k].Id == churnRequests[shard][j].second) {
@@ -411,7 +403,7 @@ namespace quantas {
 							}
 						}
 						SmartShardsMessage joinRequestMessage;
-						joinRequestMessage.messageType = "joinRequest2";
+						joinRequestMessage.messageType = SmartShardsMessageType::joinRequest2;
 						joinRequestMessage.Id = newMsg.Id;
 						joinRequestMessage.shard = minPointer->first;
 						minPointer->second++;
@@ -436,14 +428,14 @@ namespace quantas {
 					}
 				}
 			}
-			else if (newMsg.messageType == "joinRequest2") {
+			else if (newMsg.messageType == SmartShardsMessageType::joinRequest2) {
 				if (shards.find(newMsg.shard) == shards.end()) {
 					//cout << "BAD ROUTE |||||||||||||||||||||||" << endl;
 					//cout << "Node " << id() << " got joinrequest2 to shard " << newMsg.shard << endl;
 				}
 				if (shards[newMsg.shard]) {
 					//cout << "Node " << id() << " received routed joinrequest2 for " << newMsg.shard << " for node " << newMsg.Id << endl;
-					churnRequests[newMsg.shard].push_back(std::make_pair("join2", newMsg.Id));
+					churnRequests[newMsg.shard].push_back(std::make_pair(SmartShardsChurn::join2, newMsg.Id));
 				}
 				else {
 					bool foundRoute = false;
@@ -461,7 +453,7 @@ namespace quantas {
 
 				}
 			}
-			else if (newMsg.messageType == "updateMember") {
+			else if (newMsg.messageType == SmartShardsMessageType::updateMember) {
 				updateMember(newMsg.shard, newMsg.members[0]);
 			}
 			else {
@@ -472,8 +464,8 @@ namespace quantas {
 
 	void SmartShardsPeer::checkContents(int shard) {
 
-		if (shards[shard] && status[shard] == "pre-prepare") {
-			status[shard] = "prepare";
+		if (shards[shard] && status[shard] == SmartShardsStatus::pre_prepare) {
+			status[shard] = SmartShardsStatus::prepare;
 			SmartShardsMessage message;
 			for (int i = 0; i < transactions.size(); i++) {
 				if (transactions[i].trans == workingTrans[shard]) {
@@ -481,14 +473,14 @@ namespace quantas {
 					break;
 				}
 			}
-			message.messageType = "pre-prepare";
+			message.messageType = SmartShardsMessageType::pre_prepare;
 			message.Id = id();
 			message.sequenceNum = sequenceNum;
-			if (ChurnOption != 2) {
+			if (shared.ChurnOption != 2) {
 				// handl all churn requests if churn is permitted
 				// handle leaves first to figure out where to put joins nodes
 				for (int i = 0; i < churnRequests[shard].size(); i++) {
-					if (churnRequests[shard][i].first == "leave") {
+					if (churnRequests[shard][i].first == SmartShardsChurn::leave) {
 						int leavingIndex = -1;
 						for (int j = 0; j < members[shard].size(); j++) {
 							if (members[shard][j].Id == churnRequests[shard][i].second) {
@@ -510,14 +502,14 @@ namespace quantas {
 				}
 
 				for (int i = 0; i < churnRequests[shard].size(); i++) {
-					if (churnRequests[shard][i].first == "join") {
+					if (churnRequests[shard][i].first == SmartShardsChurn::join) {
 
 						message.churningNodes.push_back(churnRequests[shard][i]);
 						churnRequests[shard].erase(churnRequests[shard].begin() + i);
 						i--;
 
 					}
-					else if (churnRequests[shard][i].first == "join2") {
+					else if (churnRequests[shard][i].first == SmartShardsChurn::join2) {
 						message.churningNodes.push_back(churnRequests[shard][i]);
 						churnRequests[shard].erase(churnRequests[shard].begin() + i);
 						i--;
@@ -527,17 +519,17 @@ namespace quantas {
 			sendMessageShard(shard, message);
 			receivedMessages[message.trans].push_back(message);
 		}
-		else if (status[shard] == "pre-prepare") {
+		else if (status[shard] == SmartShardsStatus::pre_prepare) {
 			for (auto ip = receivedMessages.begin(); ip != receivedMessages.end(); ip++) {
 				if (ip->first > workingTrans[shard] && ip->second[0].shard == shard) {
 					workingTrans[shard] = ip->first;
 					if (receivedMessages.find(workingTrans[shard]) != receivedMessages.end()) {
 						for (int i = 0; i < receivedMessages[workingTrans[shard]].size(); i++) {
 							SmartShardsMessage message = receivedMessages[workingTrans[shard]][i];
-							if (message.messageType == "pre-prepare") {
-								status[shard] = "prepare";
+							if (message.messageType == SmartShardsMessageType::pre_prepare) {
+								status[shard] = SmartShardsStatus::prepare;
 								SmartShardsMessage newMsg = message;
-								newMsg.messageType = "prepare";
+								newMsg.messageType = SmartShardsMessageType::prepare;
 								newMsg.Id = id();
 								sendMessageShard(shard, newMsg);
 								receivedMessages[workingTrans[shard]].push_back(newMsg);
@@ -550,40 +542,40 @@ namespace quantas {
 			}
 		}
 
-		if (status[shard] == "prepare") {
+		if (status[shard] == SmartShardsStatus::prepare) {
 			int count = 0;
 			for (int i = 0; i < receivedMessages[workingTrans[shard]].size(); i++) {
 				SmartShardsMessage message = receivedMessages[workingTrans[shard]][i];
-				if (message.messageType == "prepare") {
+				if (message.messageType == SmartShardsMessageType::prepare) {
 					count++;
 				}
 			}
 
 			if (count > (members[shard].size() * 2 / 3)) {
-				status[shard] = "commit";
+				status[shard] = SmartShardsStatus::commit;
 				SmartShardsMessage newMsg = receivedMessages[workingTrans[shard]][0];
-				newMsg.messageType = "commit";
+				newMsg.messageType = SmartShardsMessageType::commit;
 				newMsg.Id = id();
 				sendMessageShard(shard, newMsg);
 				receivedMessages[workingTrans[shard]].push_back(newMsg);
 			}
 		}
 
-		if (status[shard] == "commit") {
+		if (status[shard] == SmartShardsStatus::commit) {
 			int count = 0;
 			for (int i = 0; i < receivedMessages[workingTrans[shard]].size(); i++) {
 				SmartShardsMessage message = receivedMessages[workingTrans[shard]][i];
-				if (message.messageType == "commit") {
+				if (message.messageType == SmartShardsMessageType::commit) {
 					count++;
 				}
 			}
 			if (count > (members[shard].size() * 2 / 3)) {
-				status[shard] = "pre-prepare";
+				status[shard] = SmartShardsStatus::pre_prepare;
 
 				SmartShardsMessage CommitMessage = receivedMessages[workingTrans[shard]][0];
 
 				for (int i = 0; i < CommitMessage.churningNodes.size(); i++) {
-					if (CommitMessage.churningNodes[i].first == "leave") {
+					if (CommitMessage.churningNodes[i].first == SmartShardsChurn::leave) {
 						if (CommitMessage.churningNodes[i].second == id()) {
 							shards.erase(shard); // Removes node from shard
 							members[CommitMessage.shard].clear();
@@ -607,7 +599,7 @@ namespace quantas {
 						}
 
 					}
-					else if (CommitMessage.churningNodes[i].first == "join" || CommitMessage.churningNodes[i].first == "join2") {
+					else if (CommitMessage.churningNodes[i].first == SmartShardsChurn::join || CommitMessage.churningNodes[i].first == SmartShardsChurn::join2) {
 						SmartShardsMember newMember;
 						newMember.Id = CommitMessage.churningNodes[i].second;
 						newMember.shards.insert(shard);
@@ -619,15 +611,15 @@ namespace quantas {
 					//cout << "Commits for shard " << shard << endl;
 					for (int j = 0; j < receivedMessages[workingTrans[shard]].size(); j++) {
 						SmartShardsMessage message = receivedMessages[workingTrans[shard]][j];
-						if (message.messageType == "commit") {
+						if (message.messageType == SmartShardsMessageType::commit) {
 							//cout << "Commit from " << message.Id << endl;
 						}
 					}
 					confirmedTrans.push_back(CommitMessage);
 					latency += getRound() - CommitMessage.roundSubmitted;
 					for (int i = 0; i < CommitMessage.churningNodes.size(); i++) {
-						if (CommitMessage.churningNodes[i].first == "join" || CommitMessage.churningNodes[i].first == "join2") {
-							CommitMessage.messageType = "joinApproved";
+						if (CommitMessage.churningNodes[i].first == SmartShardsChurn::join || CommitMessage.churningNodes[i].first == SmartShardsChurn::join2) {
+							CommitMessage.messageType = SmartShardsMessageType::joinApproved;
 							CommitMessage.members = members[shard];
 							sendMessage(CommitMessage.churningNodes[i].second, CommitMessage);
 						}
@@ -640,18 +632,18 @@ namespace quantas {
 	}
 
 	void SmartShardsPeer::submitTrans(int shard) {
-		const lock_guard<mutex> lock(currentTransaction_mutex);
+		const lock_guard<mutex> lock(shared.currentTransaction_mutex);
 		SmartShardsMessage message;
-		message.messageType = "trans";
-		message.trans = currentTransaction;
+		message.messageType = SmartShardsMessageType::trans;
+		message.trans = shared.currentTransaction;
 		message.Id = id();
 		message.roundSubmitted = getRound();
 		message.sequenceNum = sequenceNum;
 		message.shard = shard;
 		sendMessageShard(shard, message);
 		transactions.push_back(message);
-		workingTrans[shard] = currentTransaction;
-		currentTransaction++;
+		workingTrans[shard] = shared.currentTransaction;
+		shared.currentTransaction++;
 	}
 
 	void SmartShardsPeer::sendMessageShard(int shard, SmartShardsMessage message) {
@@ -663,8 +655,8 @@ namespace quantas {
 
 	void SmartShardsPeer::sendMessage(int node, SmartShardsMessage message) {
 		Packet<SmartShardsMessage> newMessage(getRound(), node, id());
-		newMessage.setMessage(message);
-		pushToOutSteam(newMessage);
+		newMessage.setMessage(std::move(message));
+		pushToOutStream(std::move(newMessage));
 		messagesSent++;
 	}
 
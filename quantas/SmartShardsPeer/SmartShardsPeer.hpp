@@ -30,18 +30,49 @@ namespace quantas {
         long Id = -1;
         bool leader = false;
         set<int> shards;
+
+        // bytes the member takes when sent (see MessageSize.hpp)
+        size_t size() const {return messageSize(Id) + messageSize(leader) + messageSize(shards);};
     };
 
+    // type of a SmartShards message
+    enum class SmartShardsMessageType { none, trans, pre_prepare, prepare, commit, joinRequest, joinRequest2, joinApproved, leaveRequest, updateMember };
+
+    // stage of consensus a node has reached in a shard
+    enum class SmartShardsStatus { none, pre_prepare, prepare, commit };
+
+    // how a churning node changes a shard, join2 is a join routed to a second shard (see joinRequest2)
+    enum class SmartShardsChurn { join, join2, leave };
+
     struct SmartShardsMessage {
 
         long 				Id = -1; // node who sent the message
         int					trans = -1; // the transaction id
         int                 sequenceNum = -1;
         int                 shard = -1; // shard the transaction is for
-        string              messageType = ""; // type of the message being sent; many options
+        SmartShardsMessageType messageType = SmartShardsMessageType::none; // type of the message being sent
         int                 roundSubmitted;
-        vector<std::pair<string, long>> churningNodes; // type of churn and id of nodes churning
+        vector<std::pair<SmartShardsChurn, long>> churningNodes; // type of churn and id of nodes churning
         vector<SmartShardsMember>       members; // the ids and other shards of the nodes in the shard (used when a node joins the shard)
+
+        // bytes the message takes when sent (see MessageSize.hpp)
+        size_t              size() const {return messageSize(Id) + messageSize(trans) + messageSize(sequenceNum) + messageSize(shard) + messageSize(messageType) + messageSize(roundSubmitted) + messageSize(churningNodes) + messageSize(members);};
+    };
+
+    // values shared by the peers of one simulation, they live in its SimulationContext
+    struct SmartShardsShared {
+        // the id of the next transaction to submit
+        int    currentTransaction = 1;
+        mutex  currentTransaction_mutex;
+        // percent of network which will request to join/leave each round
+        int    churnRate = 0;
+        // index of the next node to request to join the network
+        int    nextJoiningNode = 0;
+        // amount of time node is willing to wait before leaving
+        int    maxLeaveDelay = 100;
+        int    numberOfShards = 0;
+        // 0 - joins 2 random, 1 - joins 1 random routed to second, 2 - no churn permitted, 3 - 1 & tries to balance the shardsfor routed joins
+        int    ChurnOption = 0;
     };
 
     class SmartShardsPeer : public Peer<SmartShardsMessage>{
@@ -63,14 +94,14 @@ namespace quantas {
         ostream&             printTo(ostream&)const;
         friend ostream& operator<<         (ostream&, const SmartShardsPeer&);
 
-        // string indicating the current status of a node in each shard
-        map<int, string>                status;
+        // the current status of a node in each shard
+        map<int, SmartShardsStatus>     status;
         // list of the shards the node is in and if the node is the leader of that shard
         map<int, bool>                  shards;
         // ids and shards of the members of the shards this node is in
         map<int, vector<SmartShardsMember>>          members;
         // ids of the nodes requesting to leave/join
-        map<int, vector<std::pair<string, long>>>          churnRequests;
+        map<int, vector<std::pair<SmartShardsChurn, long>>> churnRequests;
         // tracks if node is trying to leave or join
         bool                            leaving = false;
         bool                            joining = false;
@@ -95,18 +126,8 @@ namespace quantas {
         // transaction currently being processed in a specific shard
         map<int, int>                   workingTrans;
         
-        // the id of the next transaction to submit
-        static int                      currentTransaction;
-        static mutex                    currentTransaction_mutex;
-        // percent of network which will request to join/leave each round
-        static int                      churnRate;
-        // index of the next node to request to join the network
-        static int                      nextJoiningNode;
-        // amount of time node is willing to wait before leaving
-        static int                      maxLeaveDelay;
-        static int                      numberOfShards;
-         // 0 - joins 2 random, 1 - joins 1 random routed to second, 2 - no churn permitted, 3 - 1 & tries to balance the shardsfor routed joins
-        static int                      ChurnOption;
+        // values shared with the other peers of the simulation
+        SmartShardsShared&              shared;
 
         // checkInStrm loops through the in stream adding messsages to receivedMessages or transactions
         void                  checkInStrm();
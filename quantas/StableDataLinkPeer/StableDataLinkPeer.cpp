@@ -12,31 +12,29 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int StableDataLinkPeer::currentTransaction = 1;
-
 	StableDataLinkPeer::~StableDataLinkPeer() {
 
 	}
 
-	StableDataLinkPeer::StableDataLinkPeer(const StableDataLinkPeer& rhs) : Peer<StableDataLinkMessage>(rhs) {
+	StableDataLinkPeer::StableDataLinkPeer(const StableDataLinkPeer& rhs) : Peer<StableDataLinkMessage>(rhs), shared(rhs.shared) {
 		
 	}
 
-	StableDataLinkPeer::StableDataLinkPeer(long id) : Peer(id) {
+	StableDataLinkPeer::StableDataLinkPeer(long id) : Peer(id), shared(sharedState<StableDataLinkShared>()) {
 		
 	}
 
 	void StableDataLinkPeer::performComputation() {
 		if (alive) {
 			if (getRound() == 0 && id() == 0) {
-				submitTrans(currentTransaction);
+				submitTrans(shared.currentTransaction);
 			}
 			if (previousMessageRound + timeOutRate < getRound()) {// resend lost message
 				if (id() == 0) {
 					StableDataLinkMessage message;
 					message.action = "data";
 					message.roundSubmitted = getRound(); // if message lost roundSubmitted isn't accurate
-					message.messageNum = currentTransaction - 1;
+					message.messageNum = shared.currentTransaction - 1;
 					previousMessageRound = getRound();
 					sendMessage(1, message);
 				}
@@ -44,7 +42,7 @@ namespace quantas {
 					StableDataLinkMessage message;
 					message.action = "ack";
 					message.roundSubmitted = getRound(); // if message lost roundSubmitted isn't accurate
-					message.messageNum = currentTransaction - 1;
+					message.messageNum = shared.currentTransaction - 1;
 					previousMessageRound = getRound();
 					sendMessage(0, message);
 				}
@@ -52,7 +50,7 @@ namespace quantas {
 			while (!inStreamEmpty()) {
 				Packet<StableDataLinkMessage> packet = popInStream();
 				long source = packet.sourceId();
-				StableDataLinkMessage message = packet.getMessage();
+				StableDataLinkMessage message = packet.takeMessage();
 				if (randMod(messageLossDen) < messageLossNum) { // used for message loss
 					continue;
 				}
@@ -66,7 +64,7 @@ namespace quantas {
 					else {
 						requestsSatisfied++;
 						previousMessageRound = getRound();
-						submitTrans(currentTransaction);
+						submitTrans(shared.currentTransaction);
 						ack = 0;
 					}
 				}
@@ -92,8 +90,8 @@ namespace quantas {
 
 	void StableDataLinkPeer::sendMessage(long peer, StableDataLinkMessage message) {
 		Packet<StableDataLinkMessage> newMessage(getRound(), peer, id());
-		newMessage.setMessage(message);
-		pushToOutSteam(newMessage);
+		newMessage.setMessage(std::move(message));
+		pushToOutStream(std::move(newMessage));
 		messagesSent++;
 	}
 
@@ -103,7 +101,7 @@ namespace quantas {
 		message.roundSubmitted = getRound();
 		message.messageNum = tranID;
 		sendMessage(1, message);
-		currentTransaction++;
+		shared.currentTransaction++;
 	}
 
 	std::ostream& StableDataLinkPeer::printTo(std::ostream& out)const {
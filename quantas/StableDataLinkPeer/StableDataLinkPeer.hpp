@@ -20,6 +20,15 @@ namespace quantas {
 		string action; // options are ack, data
 		int messageNum;
 		int roundSubmitted;
+
+		// bytes the message takes when sent (see MessageSize.hpp)
+		size_t size() const {return messageSize(action) + messageSize(messageNum) + messageSize(roundSubmitted);};
+	};
+
+	// values shared by the peers of one simulation, they live in its SimulationContext
+	struct StableDataLinkShared {
+		// the id of the next transaction to submit
+		int  currentTransaction = 1;
 	};
 
 	class StableDataLinkPeer : public Peer<StableDataLinkMessage> {
@@ -39,8 +48,8 @@ namespace quantas {
 		ostream& printTo(ostream&)const;
 		friend ostream& operator<<         (ostream&, const StableDataLinkPeer&);
 
-		// the id of the next transaction to submit
-		static int                      currentTransaction;
+		// values shared with the other peers of the simulation
+		StableDataLinkShared&           shared;
 		// channel size (non fifo channels not implemented channel size limit not implemented)
 		int c = 1;
 		// number of requests satisfied
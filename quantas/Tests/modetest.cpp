@@ -0,0 +1,92 @@
+// Checks that the scheduling modes give the results of the lockstep serial run. The fixture holds a
+// seeded "reference" experiment and a list of "modes", each merged into the reference as a JSON merge
+// patch. Every value the reference logs for its tests must be logged the same by each mode, which may
+// log more (skipped rounds, steps, bytes sent). Built with an algorithm like the test_ targets.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../Common/Simulation.hpp"
+#include "../Common/SimulationContext.hpp"
+#include "../Common/Json.hpp"
+
+using nlohmann::json;
+
+// the tests logged by one run of the experiment
+json runTests(const json &experiment)
+{
+    std::ostringstream out;
+    quantas::SimulationContext context;
+    context.log().setLog(out);
+    {
+        quantas::SimulationContext::Scope scope(&context);
+        quantas::SimWrapper *sim = quantas::generateSim();
+        sim->run(experiment);
+        delete sim;
+    }
+    std::string text = out.str();
+    size_t start = text.find('{');
+    json log = start == std::string::npos ? json() : json::parse(text.substr(start), nullptr, false);
+    return log.is_object() && log.contains("tests") ? log["tests"] : json();
+}
+
+// whether every value logged for the tests of reference is logged the same in results
+bool sameResults(const json &reference, const json &results)
+{
+    if (!reference.is_array() || !results.is_array() || reference.size() != results.size())
+    {
+        return false;
+    }
+    for (size_t t = 0; t < reference.size(); t++)
+    {
+        for (auto &entry : reference[t].items())
+        {
+            if (!results[t].contains(entry.key()) || results[t][entry.key()] != entry.value())
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " fixture" << std::endl;
+        return 1;
+    }
+    std::ifstream in(argv[1]);
+    if (in.fail())
+    {
+        std::cerr << "error: cannot open fixture " << argv[1] << std::endl;
+        return 1;
+    }
+    json fixture;
+    in >> fixture;
+
+    json experiment = fixture["reference"];
+    experiment["logFile"] = "cout";
+    json reference = runTests(experiment);
+    if (reference.empty())
+    {
+        std::cerr << "error: the reference logged no tests" << std::endl;
+        return 1;
+    }
+
+    int failed = 0;
+    for (auto &mode : fixture["modes"])
+    {
+        json patched = experiment;
+        patched.merge_patch(mode);
+        bool same = sameResults(reference, runTests(patched));
+        std::cout << mode.dump() << (same ? " same" : " differs") << std::endl;
+        if (!same)
+        {
+            failed = 1;
+        }
+    }
+    return failed;
+}
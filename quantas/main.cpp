@@ -14,11 +14,32 @@
 
 */
 
+// Runs the experiments of an input file. Besides "experiments" the input may set
+//  "parallelExperiments" - how many experiments run at the same time (one by default)
+//  "coreBudget"          - threads shared by the experiments running at the same time (all cores by default),
+//                          each gets a share in proportion to its size (peers x rounds x tests). The shares
+//                          are ranges of cores that do not overlap, an experiment waits for a core to be
+//                          free and its pinned workers (see Simulation) start from the first core of its range
+//  "manifest"            - file recording the experiments that completed, they are skipped when the
+//                          input is run again so an interrupted sweep can be resumed
+// Experiments running at the same time have their own results, console output is printed once an
+// experiment is done and experiments sharing a log file write to numbered copies of it.
+
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <set>
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <atomic>
 #include <chrono>
 #include <random>
+#include <algorithm>
 
 #include "Common/Network.hpp"
 #include "Common/NetworkInterface.hpp"
@@ -27,27 +48,205 @@
 
 using nlohmann::json;
 
+// 64 bit FNV-1a, the same for every build unlike std::hash
+static uint64_t stableHash(const std::string& text) {
+   uint64_t hash = 14695981039346656037ULL;
+   for (unsigned char c : text) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
+// identifies an experiment in the manifest, changing the experiment makes it run again
+static std::string experimentKey(int index, const json& experiment) {
+   return std::to_string(index) + " " + std::to_string(stableHash(experiment.dump()));
+}
+
+// cores of the budget given to the experiments that are running
+class CoreRanges {
+public:
+   explicit CoreRanges(int cores) : _used(cores, false) {}
+
+   // waits for a free core and takes up to count free cores in a row, returns the first
+   int take(int& count) {
+      std::unique_lock<std::mutex> lock(_lock);
+      int first = -1;
+      int length = 0;
+      _freed.wait(lock, [&]() {return longestFree(count, first, length);});
+      for (int c = first; c < first + length; ++c) {
+         _used[c] = true;
+      }
+      count = length;
+      return first;
+   }
+
+   void give(int first, int count) {
+      {
+         std::lock_guard<std::mutex> lock(_lock);
+         for (int c = first; c < first + count; ++c) {
+            _used[c] = false;
+         }
+      }
+      _freed.notify_all();
+   }
+
+private:
+   std::mutex _lock;
+   std::condition_variable _freed;
+   std::vector<bool> _used;
+
+   // the first run of count free cores, or the longest run if there is none that long
+   bool longestFree(int count, int& first, int& length) {
+      length = 0;
+      for (int c = 0; c < (int)_used.size();) {
+         if (_used[c]) {
+            ++c;
+            continue;
+         }
+         int end = c;
+         while (end < (int)_used.size() && !_used[end] && end - c < count) {
+            ++end;
+         }
+         if (end - c > length) {
+            first = c;
+            length = end - c;
+         }
+         if (length == count) {
+            break;
+         }
+         c = end;
+      }
+      return length > 0;
+   }
+};
+
+static std::set<std::string> readManifest(const std::string& file) {
+   std::set<std::string> done;
+   std::ifstream in(file);
+   std::string line;
+   while (std::getline(in, line)) {
+      if (!line.empty()) {
+         done.insert(line);
+      }
+   }
+   return done;
+}
+
+static double experimentSize(const json& experiment) {
+   double peers = experiment["topology"]["totalPeers"];
+   double rounds = experiment["rounds"];
+   double tests = experiment["tests"];
+   return std::max(1.0, peers * rounds * tests);
+}
+
 int main(int argc, const char* argv[]) {
    if (argc < 2) {
       std::cerr << "usage: " << argv[0] << " inputFileName "<< std::endl;
       return 1;
    }
-	
+
    std::ifstream inFile(argv[1]);
-	
+
    if (inFile.fail()) {
       std::cerr << "error: cannot open input file" << std::endl;
       return 1;
    }
-	
+
    json config;
    inFile >> config;
 
+   std::string manifest = config.contains("manifest") ? config["manifest"].get<std::string>() : "";
+   std::set<std::string> done;
+   if (!manifest.empty()) {
+      done = readManifest(manifest);
+   }
+
+   // experiments left to run
+   std::vector<int> pending;
+   std::map<std::string, int> logFiles;
    for (int i = 0; i < config["experiments"].size(); ++i) {
       json input = config["experiments"][i];
-      quantas::SimWrapper* sim = quantas::generateSim();
-	   sim->run(input);
-      delete sim;
+      logFiles[input["logFile"]]++;
+      if (done.count(experimentKey(i, input)) == 0) {
+         pending.push_back(i);
+      }
+   }
+
+   int parallelExperiments = 1;
+   if (config.contains("parallelExperiments") && config["parallelExperiments"] > 1) {
+      parallelExperiments = std::min(static_cast<int>(config["parallelExperiments"]), static_cast<int>(pending.size()));
+   }
+   int coreBudget = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+   if (config.contains("coreBudget") && config["coreBudget"] > 0) {
+      coreBudget = config["coreBudget"];
+   }
+   double averageSize = 0;
+   for (int i : pending) {
+      averageSize += experimentSize(config["experiments"][i]) / pending.size();
+   }
+
+   std::mutex outputLock; // guards the console and the manifest
+   CoreRanges cores(coreBudget);
+   std::atomic<int> next(0);
+   auto runner = [&]() {
+      for (int p = next++; p < pending.size(); p = next++) {
+         int i = pending[p];
+         json input = config["experiments"][i];
+         std::ostringstream console;
+         quantas::SimulationContext context;
+         int firstCore = 0;
+         int share = 0;
+         if (parallelExperiments > 1) {
+            // a share of the budget in proportion to the experiment's size, never more than it asks for
+            share = static_cast<int>(coreBudget * experimentSize(input) / averageSize / parallelExperiments + 0.5);
+            share = std::max(1, std::min(share, coreBudget));
+            if (input.contains("threadCount") && input["threadCount"] > 0 && input["threadCount"] < share) {
+               share = input["threadCount"];
+            }
+            // the cores taken may be fewer than the share when the others are in use
+            firstCore = cores.take(share);
+            input["threadCount"] = share;
+            input["firstCore"] = firstCore;
+            if (input["logFile"] == "cout") {
+               context.log().setLog(console);
+            }
+            else if (logFiles[input["logFile"]] > 1) {
+               std::string file = input["logFile"];
+               size_t dot = file.find_last_of('.');
+               input["logFile"] = dot == std::string::npos ? file + "_" + std::to_string(i) : file.substr(0, dot) + "_" + std::to_string(i) + file.substr(dot);
+            }
+         }
+         {
+            quantas::SimulationContext::Scope scope(&context);
+            quantas::SimWrapper* sim = quantas::generateSim();
+            sim->run(input);
+            delete sim;
+         }
+         if (share > 0) {
+            cores.give(firstCore, share);
+         }
+
+         std::lock_guard<std::mutex> lock(outputLock);
+         std::cout << console.str();
+         if (!manifest.empty()) {
+            std::ofstream out(manifest, std::ios::app);
+            out << experimentKey(i, config["experiments"][i]) << std::endl;
+         }
+      }
+   };
+
+   if (parallelExperiments <= 1) {
+      runner();
+   }
+   else {
+      std::vector<std::thread> runners;
+      for (int r = 0; r < parallelExperiments; ++r) {
+         runners.push_back(std::thread(runner));
+      }
+      for (auto& thread : runners) {
+         thread.join();
+      }
    }
 
    return 0;